@@ -52,16 +52,20 @@ namespace gdf
         void clear( );
 
         /// Add a physical sample to the channel.
-        /** value is scaled from [phys_min..phys_max] to [dig_min..dig_max] and converted to the channel's data type */
-        void addSamplePhys( const double value );
+        /** value is scaled from [phys_min..phys_max] to [dig_min..dig_max] and converted to the channel's data type.
+            Integer types are rounded to the nearest value. Out of range values are clamped if saturate is true, otherwise
+            boost::numeric::bad_numeric_cast is thrown. */
+        void addSamplePhys( const double value, bool saturate = false );
 
         /// Add a raw sample to the channel.
         /** value is converted to the channel's data type. but otherwise remains unmodified */
         template<typename T> void addSampleRaw( const T rawval );
 
         /// Blit a number of physical samples into channel.
-        /** values are scaled from [phys_min..phys_max] to [dig_min..dig_max] and converted to the channel's data type */
-        void blitSamplesPhys( const double *values, size_t num );
+        /** values are scaled from [phys_min..phys_max] to [dig_min..dig_max] and converted to the channel's data type.
+            Rounding and range handling are the same as in addSamplePhys(). If a value is out of range and saturate is false,
+            no sample is added. */
+        void blitSamplesPhys( const double *values, size_t num, bool saturate = false );
 
         /// Blit a number of raw samples into channel.
         /** values are converted to the channel's data type but otherwise remains unmodified */
@@ -82,11 +86,19 @@ namespace gdf
         double getSamplePhys( size_t pos );
 
         /// Blit a number of physical samples from channel to buffer.
-        /** values are scaled from [dig_min..dig_max] to [phys_min..phys_max] and converted to double */
-        void deblitSamplesPhys( double *values, size_t start, size_t num );
+        /** values are scaled from [dig_min..dig_max] to [phys_min..phys_max] and converted to double.
+            Sample i is written to values[i*stride]. */
+        void deblitSamplesPhys( double *values, size_t start, size_t num, size_t stride = 1 );
+
+        /// Blit a number of physical samples from channel to buffer.
+        /** values are scaled from [dig_min..dig_max] to [phys_min..phys_max] and converted to float.
+            Sample i is written to values[i*stride]. */
+        void deblitSamplesPhys( float *values, size_t start, size_t num, size_t stride = 1 );
 
         /// Blit a number of raw samples from channel to buffer.
-        template<typename T> void deblitSamplesRaw( T *values, size_t start, size_t num );
+        /** T must be the channel's data type, otherwise exception::bad_type_assigned_to_channel is thrown.
+            Sample i is written to values[i*stride]. */
+        template<typename T> void deblitSamplesRaw( T *values, size_t start, size_t num, size_t stride = 1 );
 
         /// Get number of free samples
         size_t getFree( );
@@ -97,6 +109,9 @@ namespace gdf
         /// Get type of channel
         uint32 getTypeID( );
 
+        /// Read all samples of the channel from a memory buffer in file representation.
+        void frombuffer( const char *in );
+
         friend std::ostream &operator<<( std::ostream &out, const Channel &c );
         friend std::istream &operator>>( std::istream &in, Channel &c );
 
@@ -145,6 +160,14 @@ namespace gdf
             addSampleRaw( values[i] );
     }
 
+    //===================================================================================================
+    //===================================================================================================
+
+    template<typename T> void Channel::deblitSamplesRaw( T *values, size_t start, size_t num, size_t stride )
+    {
+        m_data->deblitSamples( values, start, num, stride );
+    }
+
 }
 
 #endif
@@ -20,6 +20,7 @@
 #define __CHANNELDATA_H_INCLUDED
 
 #include "ChannelDataBase.h"
+#include "Conversion.h"
 #include <vector>
 #include <stddef.h>
 #include <assert.h>
@@ -75,6 +76,16 @@ namespace gdf
                 m_data[m_writepos++] = values[i];
         }
 
+        /// Quantize a given number of physical samples into channel. That number of samples must be free.
+        void blitSamplesPhys( const float64 *values, size_t num, double scale, double offset, bool saturate )
+        {
+            assert( getFree( ) >= num );
+            if( num == 0 )
+                return;
+            convertPhysToRaw( values, &m_data[m_writepos], num, scale, offset, saturate );
+            m_writepos += num;
+        }
+
         /// Fills a given number of samples with value. That number of samples must be free.
         void fill( const T value, const size_t num )
         {
@@ -95,6 +106,35 @@ namespace gdf
             return m_data[pos];
         }
 
+        /// Copy num raw samples starting at start to values. Sample i is written to values[i*stride].
+        void deblitSamples( T *values, size_t start, size_t num, size_t stride )
+        {
+            assert( start + num <= m_data.size( ) );
+            if( num == 0 )
+                return;
+            if( stride == 1 )
+                memcpy( values, &m_data[start], num * sizeof(T) );
+            else
+                for( size_t i=0; i<num; i++ )
+                    values[i*stride] = m_data[start+i];
+        }
+
+        /// Convert num samples starting at start to physical units
+        void deblitSamplesPhys( float64 *values, size_t start, size_t num, double scale, double offset, size_t stride )
+        {
+            assert( start + num <= m_data.size( ) );
+            if( num > 0 )
+                convertRawToPhys( &m_data[start], values, num, scale, offset, stride );
+        }
+
+        /// Convert num samples starting at start to physical units
+        void deblitSamplesPhys( float32 *values, size_t start, size_t num, double scale, double offset, size_t stride )
+        {
+            assert( start + num <= m_data.size( ) );
+            if( num > 0 )
+                convertRawToPhys( &m_data[start], values, num, scale, offset, stride );
+        }
+
         /// Reset read and write positions
         virtual void clear( )
         {
@@ -116,34 +156,44 @@ namespace gdf
         /// Serializer
         void tostream( std::ostream &out )
         {
-            //std::cout << "Channel -> Stream" << std::endl;
-            //out.write( reinterpret_cast<char*>(&m_data[0]), sizeof(T)*m_data.size() );
+            if( m_data.size( ) == 0 )
+                return;
+#if BOOST_ENDIAN_LITTLE_BYTE
+            out.write( reinterpret_cast<const char*>(&m_data[0]), sizeof(T)*m_data.size() );
+#else
             for( size_t i=0; i<m_data.size(); i++ )
             {
                 writeLittleEndian( out, m_data[i] );
             }
+#endif
         }
 
         /// Deserializer
+        /** The whole channel is read with a single read. On big endian hosts the samples are swapped afterwards. */
         void fromstream( std::istream &in )
         {
-            //std::cout << "Stream -> Channel" << std::endl;
-            //in.read( reinterpret_cast<char*>(&m_data[0]), sizeof(T)*m_data.size() );
-
-            for( size_t i=0; i<m_data.size(); i++ )
-            {
-                readLittleEndian( in, m_data[i] );
-            }
-
-            //char *charbuf = new char[sizeof(T)*m_data.size()];
-
-            /*in.read( charbuf, sizeof(T)*m_data.size() );
+            if( m_data.size( ) == 0 )
+                return;
+#if BOOST_ENDIAN_LITTLE_BYTE
+            in.read( reinterpret_cast<char*>(&m_data[0]), sizeof(T)*m_data.size() );
+#else
+            std::vector<char> charbuf( sizeof(T)*m_data.size() );
+            in.read( &charbuf[0], charbuf.size() );
+            frombuffer( &charbuf[0] );
+#endif
+        }
 
+        /// Deserialize from memory
+        void frombuffer( const char *in )
+        {
+            if( m_data.size( ) == 0 )
+                return;
+#if BOOST_ENDIAN_LITTLE_BYTE
+            memcpy( &m_data[0], in, sizeof(T)*m_data.size() );
+#else
             for( size_t i=0; i<m_data.size(); i++ )
-                std::cout << ((T*)charbuf)[i] << " ";*/
-
-            /*for( size_t i=0; i<m_data.size(); i++ )
-                std::cout << m_data[i] << " ";*/
+                readLittleEndian( in + i*sizeof(T), m_data[i] );
+#endif
         }
 
     protected:
@@ -92,6 +92,27 @@ namespace gdf
         virtual float32 getSample( size_t, float32 /*dummy*/ ) { throw exception::bad_type_assigned_to_channel( ); }
         virtual float64 getSample( size_t, float64 /*dummy*/ ) { throw exception::bad_type_assigned_to_channel( ); }
 
+        virtual void deblitSamples( int8*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( uint8*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( int16*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( uint16*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( int32*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( uint32*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( int64*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( uint64*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( float32*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+        virtual void deblitSamples( float64*, size_t, size_t, size_t ) { throw exception::bad_type_assigned_to_channel( ); }
+
+        /// Convert num samples starting at start to physical units: phys = raw * scale + offset. Sample i is written to values[i*stride].
+        virtual void deblitSamplesPhys( float64 *values, size_t start, size_t num, double scale, double offset, size_t stride ) = 0;
+
+        /// Convert num samples starting at start to physical units: phys = raw * scale + offset. Sample i is written to values[i*stride].
+        virtual void deblitSamplesPhys( float32 *values, size_t start, size_t num, double scale, double offset, size_t stride ) = 0;
+
+        /// Quantize num physical samples and append them: raw = phys * scale + offset. That number of samples must be free.
+        /** @throws boost::numeric::positive_overflow, boost::numeric::negative_overflow if a value is out of range and saturate is false */
+        virtual void blitSamplesPhys( const float64 *values, size_t num, double scale, double offset, bool saturate ) = 0;
+
         /// Reset read and write positions
         virtual void clear( ) = 0;
 
@@ -106,6 +127,9 @@ namespace gdf
 
         /// Deserializer
         virtual void fromstream( std::istream &in ) = 0;
+
+        /// Deserialize from a memory buffer that holds the channel's little endian samples.
+        virtual void frombuffer( const char *in ) = 0;
     };
 
 }
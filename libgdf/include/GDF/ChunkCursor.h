@@ -0,0 +1,103 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#ifndef __CHUNKCURSOR_H_INCLUDED__
+#define __CHUNKCURSOR_H_INCLUDED__
+
+#include "Types.h"
+#include <vector>
+#include <stddef.h>
+
+namespace gdf
+{
+    class Reader;
+
+    /// Pull based cursor over fixed size, optionally overlapping, multi-channel windows
+    /** Created by Reader::scan(). Each call to next() advances the window by hop samples and fills a single
+        channel-major buffer with physical samples: sample n of the i-th channel is at getData()[i*getChunkSamples() + n].
+        Samples that overlap the previous window are moved within the buffer and only the new samples are read.
+        Records are read through the Reader's staging buffer and never enter the record cache, so memory use does not
+        depend on the length of the recording.
+
+        All channels must have the same sampling rate. The Reader must stay open while the cursor is used, and must
+        not be used from another thread at the same time.
+        Example:
+        @code
+        ChunkCursor cursor = reader.scan( channels, 1024, 512 );
+        while( cursor.next( ) )
+            process( cursor.getChannel( 0 ), cursor.getNumSamples( ) );
+        @endcode
+      */
+    class ChunkCursor
+    {
+    public:
+        /// Constructor
+        /** @param[in] reader open Reader
+            @param[in] signal_indices channels to read. If empty, all signals are read.
+            @param[in] chunk_samples window length in samples
+            @param[in] hop distance between the starts of consecutive windows. hop = 0 means hop = chunk_samples.
+            @throws exception::invalid_operation if chunk_samples is 0 or the channels have different sampling rates
+          */
+        ChunkCursor( Reader *reader, const std::vector<uint16> &signal_indices, size_t chunk_samples, size_t hop = 0 );
+
+        /// Advance to the next window.
+        /** The first call loads the window starting at sample 0. The last window may be shorter than chunk_samples.
+            @return false if there are no more samples; the buffer is not modified in that case. */
+        bool next( );
+
+        /// Rewind, so that the next call to next() loads the first window again
+        void reset( );
+
+        /// Channel-major sample buffer of the current window
+        const double *getData( ) const { return m_buffer.empty( ) ? NULL : &m_buffer[0]; }
+
+        /// Samples of the i-th channel of the current window
+        const double *getChannel( size_t i ) const { return getData( ) + i * m_chunk; }
+
+        /// Number of valid samples per channel in the current window
+        size_t getNumSamples( ) const { return m_valid; }
+
+        /// Index of the first sample of the current window
+        size_t getPosition( ) const { return m_position; }
+
+        /// Window length
+        size_t getChunkSamples( ) const { return m_chunk; }
+
+        /// Distance between consecutive windows
+        size_t getHop( ) const { return m_hop; }
+
+        /// Number of channels in each window
+        size_t getNumChannels( ) const { return m_signal_indices.size( ); }
+
+        /// Channel indices of the windows
+        const std::vector<uint16> &getSignalIndices( ) const { return m_signal_indices; }
+
+    private:
+        Reader *m_reader;
+        std::vector<uint16> m_signal_indices;
+        size_t m_chunk;
+        size_t m_hop;
+        size_t m_total;         /// Number of samples in each channel
+        size_t m_position;
+        size_t m_valid;
+        bool m_started;
+        std::vector<double> m_buffer;
+    };
+}
+
+#endif
@@ -0,0 +1,152 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#ifndef __CONCURRENTREADER_H_INCLUDED__
+#define __CONCURRENTREADER_H_INCLUDED__
+
+#include "EventHeader.h"
+#include "GDFHeaderAccess.h"
+#include "Types.h"
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gdf
+{
+    class DataSource;
+
+    /// Class for reading GDF files from several threads at once.
+    /** Unlike Reader, all data access functions of ConcurrentReader may be called from multiple threads at the same
+        time on one open file. Data records are read with positional reads (pread), so there is no shared seek state,
+        and the record cache is split into independently locked shards. Records are cached in their file
+        representation and decoded by the calling thread.
+
+        open(), close(), enableCache() and setMaxCacheRecords() are not thread safe and must not be called while
+        other threads access the reader.
+      */
+    class ConcurrentReader
+    {
+    public:
+        /// Constructor
+        ConcurrentReader( );
+
+        /// Destructor
+        virtual ~ConcurrentReader( );
+
+        /// Opens file for reading
+        /** @throws exception::file_exists_not */
+        void open( const std::string filename );
+
+        /// Close file
+        void close( );
+
+        /// Enable or disable the record cache (enabled by default)
+        void enableCache( bool b );
+
+        /// Limit the number of records kept in the cache.
+        /** The limit is split over the cache shards, so that together they never hold more than num records. Each
+            shard evicts its least recently used record; records of shards without a share are not cached.
+            @param[in] num maximum number of cached records; 0 means no limit (default).
+          */
+        void setMaxCacheRecords( size_t num );
+
+        /// Returns the number of records currently held in the cache
+        size_t getNumCachedRecords( );
+
+        /// Read Signals from file into buffer (physical units)
+        /** Thread safe. See Reader::getSignals() */
+        void getSignals( std::vector< std::vector<double> > &buffer, double start_time = 0, double end_time = -1, std::vector<uint16> signal_indices = std::vector<uint16>() );
+
+        /// Read a single channel from file into buffer.
+        /** Thread safe. See Reader::getSignal() */
+        void getSignal( uint16 channel_idx, double *buffer, size_t start = 0, size_t end = 0 );
+
+        /// Read a single Sample (physical units)
+        /** Thread safe.
+            @throws exception::index_out_of_range if sample_idx is past the end of the channel */
+        double getSample( uint16 channel_idx, size_t sample_idx );
+
+        /// get reference to event header
+        /** The event table is read on first access. Thread safe. */
+        EventHeader *getEventHeader( );
+
+        /// get Constant reference to header access
+        const GDFHeaderAccess &getHeaderAccess_readonly( ) const { return m_header; }
+
+        /// get Constant reference to main header
+        const MainHeader &getMainHeader_readonly( ) const { return m_header.getMainHeader_readonly( ); }
+
+        /// get constant reference to a signal's header
+        const SignalHeader &getSignalHeader_readonly( size_t idx ) const { return m_header.getSignalHeader_readonly(idx); }
+
+    protected:
+        typedef boost::shared_ptr< const std::vector<char> > RawRecordPtr;
+
+        /// File representation of data record index; from the cache or read from disk
+        RawRecordPtr getRawRecord( size_t index );
+
+        /// Decode the sample ranges [start,end) of signal_indices into out, one buffer per signal
+        /** Records are read in blocks of Reader::getBlockRecords() if the cache is disabled. */
+        void readSignals( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end,
+                          const std::vector<double*> &out );
+
+        /// Read num records starting with start into buffer
+        void readRecords( size_t start, size_t num, char *buffer ) const;
+
+        /// Convert samples of a channel from the file representation of a record to physical units
+        void deblitRawSamplesPhys( uint16 channel_idx, const char *record, double *buffer, size_t start, size_t num ) const;
+
+        /// Drop all cached records
+        void resetCache( );
+
+        /// One independently locked part of the record cache
+        struct CacheShard
+        {
+            boost::mutex mutex;
+            std::list<size_t> lru;  /// Cached record indices, least recently used first
+            std::map< size_t, std::pair< RawRecordPtr, std::list<size_t>::iterator > > records;
+        };
+
+        static const size_t NUM_SHARDS = 16;
+
+        std::string m_filename;
+        GDFHeaderAccess m_header;
+        DataSource *m_source;
+        EventHeader *m_events;
+        boost::mutex m_event_mutex;
+
+        CacheShard m_shards[NUM_SHARDS];
+        bool m_cache_enabled;
+        size_t m_cache_max_records;
+
+        size_t m_num_records;
+        size_t m_record_length; /// Record length in bytes
+        size_t m_record_offset; /// Where data records start in the file
+        size_t m_event_offset;  /// Where the event table starts in the file
+        std::vector<size_t> m_channel_offset;   /// Where each channel starts within a record
+
+    private:
+        ConcurrentReader( const ConcurrentReader & );
+        ConcurrentReader &operator=( const ConcurrentReader & );
+    };
+}
+
+#endif // __CONCURRENTREADER_H_INCLUDED__
@@ -0,0 +1,168 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#ifndef __CONVERSION_H_INCLUDED__
+#define __CONVERSION_H_INCLUDED__
+
+#include "Types.h"
+#include <boost/numeric/conversion/converter_policies.hpp>
+#include <limits>
+#include <math.h>
+#include <stddef.h>
+
+namespace gdf
+{
+    /// Convert a span of raw samples to physical units.
+    /** phys = raw * scale + offset. The loop contains no branches or calls so that the compiler can
+        vectorize it for each combination of raw and physical type. Output sample i is written to
+        phys[i*stride].
+    */
+    template<typename T, typename U>
+    void convertRawToPhys( const T *raw, U *phys, size_t num, double scale, double offset, size_t stride = 1 )
+    {
+        if( stride == 1 )
+        {
+            for( size_t i=0; i<num; i++ )
+                phys[i] = static_cast<U>( static_cast<double>( raw[i] ) * scale + offset );
+        }
+        else
+        {
+            for( size_t i=0; i<num; i++ )
+                phys[i*stride] = static_cast<U>( static_cast<double>( raw[i] ) * scale + offset );
+        }
+    }
+
+    /// Convert a span of raw samples in little endian file representation to physical units.
+    /** The input does not need to be aligned. Output sample i is written to phys[i*stride]. */
+    template<typename T, typename U>
+    void convertRawToPhys( const char *in, U *phys, size_t num, double scale, double offset, size_t stride = 1 )
+    {
+        T raw;
+        for( size_t i=0; i<num; i++ )
+        {
+            readLittleEndian( in + i*sizeof(T), raw );
+            phys[i*stride] = static_cast<U>( static_cast<double>( raw ) * scale + offset );
+        }
+    }
+
+    /// Copy a span of raw samples in little endian file representation to native raw samples.
+    /** On little endian hosts a contiguous span is copied with a single memcpy. Output sample i is written to raw[i*stride]. */
+    template<typename T>
+    void copyRawSamples( const char *in, T *raw, size_t num, size_t stride = 1 )
+    {
+#if BOOST_ENDIAN_LITTLE_BYTE
+        if( stride == 1 )
+        {
+            memcpy( raw, in, num * sizeof(T) );
+            return;
+        }
+#endif
+        for( size_t i=0; i<num; i++ )
+            readLittleEndian( in + i*sizeof(T), raw[i*stride] );
+    }
+
+    /// Convert a span of raw samples of GDF type datatype in file representation to physical units.
+    /** Dispatches once on datatype.
+        @throws exception::invalid_type_id
+    */
+    void convertRawToPhys( uint32 datatype, const char *in, float64 *phys, size_t num, double scale, double offset, size_t stride = 1 );
+
+    /// Smallest double that is a valid value of raw type T
+    template<typename T> double rawLowest( )
+    {
+        return std::numeric_limits<T>::is_integer ? static_cast<double>( std::numeric_limits<T>::min( ) ) : -static_cast<double>( std::numeric_limits<T>::max( ) );
+    }
+
+    /// Largest double that is a valid value of raw type T
+    /** For 64 bit integers the maximum is not exactly representable as double; the next lower double is used instead. */
+    template<typename T> double rawHighest( )
+    {
+        double hi = static_cast<double>( std::numeric_limits<T>::max( ) );
+        if( std::numeric_limits<T>::is_integer && std::numeric_limits<T>::digits >= std::numeric_limits<double>::digits )
+            hi = nextafter( hi, 0.0 );
+        return hi;
+    }
+
+    /// Convert a span of physical samples to raw samples of type T.
+    /** raw = phys * scale + offset, rounded to the nearest integer for integer types.
+        If saturate is true, values outside the range of T are clamped to the range. NaN becomes the lowest value
+        for integer types and is passed through for float32.
+        Otherwise the whole span is checked before anything is written, so that out of range values leave raw untouched.
+        @throws boost::numeric::positive_overflow, boost::numeric::negative_overflow if saturate is false
+    */
+    template<typename T>
+    void convertPhysToRaw( const double *phys, T *raw, size_t num, double scale, double offset, bool saturate )
+    {
+        const double lo = rawLowest<T>( );
+        const double hi = rawHighest<T>( );
+        const bool is_int = std::numeric_limits<T>::is_integer;
+        const double round = is_int ? 0.5 : 0.0;
+
+        if( saturate )
+        {
+            for( size_t i=0; i<num; i++ )
+            {
+                double x = phys[i] * scale + offset;
+                x = is_int ? ( x > lo ? x : lo ) : ( x < lo ? lo : x );
+                x = is_int ? ( x < hi ? x : hi ) : ( x > hi ? hi : x );
+                raw[i] = static_cast<T>( x < 0 ? x - round : x + round );
+            }
+            return;
+        }
+
+        // values are valid if they round into [lo,hi]; integers are rounded away from zero, so
+        // lo - 0.5 and hi + 0.5 themselves are out of range. At the bounds of 64 bit integers half a step is
+        // below the resolution of double, lo - 0.5 == lo and hi + 0.5 == hi, and the bounds are valid.
+        const double lo_ok = lo - round;
+        const double hi_ok = hi + round;
+        const bool lo_strict = lo_ok != lo;
+        const bool hi_strict = hi_ok != hi;
+        bool below = false, above = false;
+        for( size_t i=0; i<num; i++ )
+        {
+            double x = phys[i] * scale + offset;
+            below |= is_int ? ( lo_strict ? !( x > lo_ok ) : !( x >= lo_ok ) ) : x < lo_ok;
+            above |= hi_strict ? x >= hi_ok : x > hi_ok;
+        }
+        if( above )
+            throw boost::numeric::positive_overflow( );
+        if( below )
+            throw boost::numeric::negative_overflow( );
+
+        for( size_t i=0; i<num; i++ )
+        {
+            double x = phys[i] * scale + offset;
+            raw[i] = static_cast<T>( x < 0 ? x - round : x + round );
+        }
+    }
+
+    /// Convert a span of physical samples to float64 raw samples; no range check is necessary.
+    inline void convertPhysToRaw( const double *phys, float64 *raw, size_t num, double scale, double offset, bool /*saturate*/ )
+    {
+        for( size_t i=0; i<num; i++ )
+            raw[i] = phys[i] * scale + offset;
+    }
+
+    /// Convert a span of raw samples of GDF type datatype in file representation to physical units.
+    /** Dispatches once on datatype.
+        @throws exception::invalid_type_id
+    */
+    void convertRawToPhys( uint32 datatype, const char *in, float32 *phys, size_t num, double scale, double offset, size_t stride = 1 );
+}
+
+#endif
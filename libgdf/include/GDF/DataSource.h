@@ -0,0 +1,350 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#ifndef __DATASOURCE_H_INCLUDED__
+#define __DATASOURCE_H_INCLUDED__
+
+#include "Types.h"
+#include <boost/thread/mutex.hpp>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <fstream>
+#endif
+
+namespace boost
+{
+    namespace interprocess
+    {
+        class file_mapping;
+        class mapped_region;
+    }
+}
+
+namespace gdf
+{
+    class IoUring;
+
+    /// One positional read of a batch
+    struct ReadRequest
+    {
+        uint64 offset;  ///< Position of the first byte in the source
+        char *buffer;   ///< Destination of the bytes
+        size_t bytes;   ///< Number of bytes to read
+    };
+
+    /// Random access source of bytes
+    /** Reads are positional: they do not change any shared file position, so implementations can be
+        used by several threads at the same time.
+      */
+    class DataSource
+    {
+    public:
+        /// Destructor
+        virtual ~DataSource( ) { }
+
+        /// Read bytes starting at offset into buffer
+        /** @throws exception::serialization_error if fewer than bytes bytes are available */
+        virtual void readAt( uint64 offset, char *buffer, size_t bytes ) const = 0;
+
+        /// Read up to bytes bytes starting at offset into buffer
+        /** @return number of bytes read; less than bytes only at the end of the source */
+        virtual size_t readSome( uint64 offset, char *buffer, size_t bytes ) const;
+
+        /// Perform all reads in requests; the order in which they complete is unspecified
+        /** The default implementation calls readAt() for each request.
+            @throws exception::serialization_error if fewer bytes than requested are available */
+        virtual void readBatch( const std::vector<ReadRequest> &requests ) const;
+
+        /// Total number of bytes in the source
+        virtual uint64 size( ) const = 0;
+
+        /// Contiguous view of all bytes of the source, or NULL if the source is not in memory
+        /** If available, Reader decodes data records in place instead of copying them. */
+        virtual const char *data( ) const { return NULL; }
+    };
+
+    /// DataSource reading from a file with pread()
+    /** On platforms without pread the file is read through a stream that is protected by a mutex.
+        If libGDF is built with GDF_WITH_IO_URING on Linux, readBatch() submits the reads to an io_uring
+        so that many of them are in flight at once. If the kernel refuses to set up the ring, pread() is used.
+      */
+    class FileSource : public DataSource
+    {
+    public:
+        /// Opens filename for reading
+        /** @throws exception::file_exists_not */
+        FileSource( const std::string filename );
+
+        /// Destructor; closes the file
+        virtual ~FileSource( );
+
+        void readAt( uint64 offset, char *buffer, size_t bytes ) const;
+
+        void readBatch( const std::vector<ReadRequest> &requests ) const;
+
+        uint64 size( ) const { return m_size; }
+
+        /// Returns true if readBatch() is served by io_uring
+        /** The ring is set up by the first call to readBatch(), so this returns false before. */
+        bool usesIoUring( ) const { return m_ring != NULL; }
+
+    private:
+        FileSource( const FileSource & );
+        FileSource &operator=( const FileSource & );
+
+        uint64 m_size;
+        mutable IoUring *m_ring;        ///< Ring for readBatch(), NULL if not (yet) available
+        mutable bool m_ring_tried;      ///< Setting up the ring was attempted
+        mutable boost::mutex m_ring_mutex;
+#ifdef _WIN32
+        mutable std::ifstream m_file;
+        mutable boost::mutex m_mutex;
+#else
+        int m_fd;
+#endif
+    };
+
+    /// DataSource mapping a file into memory
+    class MappedSource : public DataSource
+    {
+    public:
+        /// Maps filename read-only
+        /** @throws exception::file_exists_not */
+        MappedSource( const std::string filename );
+
+        /// Destructor; unmaps the file
+        virtual ~MappedSource( );
+
+        void readAt( uint64 offset, char *buffer, size_t bytes ) const;
+
+        uint64 size( ) const { return m_size; }
+
+        const char *data( ) const { return m_data; }
+
+    private:
+        MappedSource( const MappedSource & );
+        MappedSource &operator=( const MappedSource & );
+
+        boost::interprocess::file_mapping *m_mapping;
+        boost::interprocess::mapped_region *m_region;
+        const char *m_data;
+        uint64 m_size;
+    };
+
+    /// DataSource reading from a buffer in memory
+    class MemorySource : public DataSource
+    {
+    public:
+        /// Reads from an external buffer, which is not copied and must stay valid as long as the source is used
+        MemorySource( const char *data, size_t size );
+
+        /// Takes over the contents of buffer; buffer is left empty
+        MemorySource( std::vector<char> &buffer );
+
+        void readAt( uint64 offset, char *buffer, size_t bytes ) const;
+
+        uint64 size( ) const { return m_size; }
+
+        const char *data( ) const { return m_data; }
+
+    private:
+        MemorySource( const MemorySource & );
+        MemorySource &operator=( const MemorySource & );
+
+        std::vector<char> m_buffer;
+        const char *m_data;
+        size_t m_size;
+    };
+
+    /// DataSource reading from a sequential stream such as a pipe or socket
+    /** The stream is read on demand, and everything read so far is kept in memory, so that earlier bytes can be
+        read again. size() reads the stream to its end. Reads are serialized by a mutex.
+      */
+    class PipeSource : public DataSource
+    {
+    public:
+        /// Reads from in, which must stay valid as long as the source is used
+        PipeSource( std::istream &in );
+
+        void readAt( uint64 offset, char *buffer, size_t bytes ) const;
+
+        size_t readSome( uint64 offset, char *buffer, size_t bytes ) const;
+
+        uint64 size( ) const;
+
+    private:
+        PipeSource( const PipeSource & );
+        PipeSource &operator=( const PipeSource & );
+
+        /// Read from the stream until at least end bytes are buffered or the stream ends; the mutex must be held
+        void fill( uint64 end ) const;
+
+        std::istream &m_in;
+        mutable std::vector<char> m_buffer;
+        mutable bool m_eof;
+        mutable boost::mutex m_mutex;
+    };
+
+    /// Random access sink of bytes
+    class DataSink
+    {
+    public:
+        /// Destructor
+        virtual ~DataSink( ) { }
+
+        /// Write bytes from buffer starting at offset
+        /** Writing beyond the current end extends the sink.
+            @throws exception::serialization_error if the data can not be written
+            @throws exception::invalid_operation if the sink is not seekable and offset is not the current end */
+        virtual void writeAt( uint64 offset, const char *buffer, size_t bytes ) = 0;
+
+        /// Number of bytes in the sink
+        virtual uint64 size( ) const = 0;
+
+        /// Returns false if data can only be appended
+        virtual bool isSeekable( ) const { return true; }
+
+        /// Pass buffered data on to the underlying device
+        virtual void flush( ) { }
+    };
+
+    /// DataSink writing to a file with pwrite()
+    /** On platforms without pwrite the file is written through a stream. */
+    class FileSink : public DataSink
+    {
+    public:
+        /// Creates or truncates filename
+        /** @throws exception::serialization_error if the file can not be created */
+        FileSink( const std::string filename );
+
+        /// Destructor; closes the file
+        virtual ~FileSink( );
+
+        void writeAt( uint64 offset, const char *buffer, size_t bytes );
+
+        uint64 size( ) const { return m_size; }
+
+    private:
+        FileSink( const FileSink & );
+        FileSink &operator=( const FileSink & );
+
+        uint64 m_size;
+#ifdef _WIN32
+        std::ofstream m_file;
+#else
+        int m_fd;
+#endif
+    };
+
+    /// DataSink writing to a growing buffer in memory
+    class MemorySink : public DataSink
+    {
+    public:
+        void writeAt( uint64 offset, const char *buffer, size_t bytes );
+
+        uint64 size( ) const { return m_buffer.size( ); }
+
+        /// Bytes written so far
+        const std::vector<char> &getBuffer( ) const { return m_buffer; }
+
+        /// Move the bytes written so far to buffer and empty the sink
+        void takeBuffer( std::vector<char> &buffer ) { buffer.clear( ); m_buffer.swap( buffer ); }
+
+    private:
+        std::vector<char> m_buffer;
+    };
+
+    /// DataSink appending to a sequential stream such as a pipe or socket
+    /** Data can only be appended. Writer leaves the number of data records in the header at -1 (unknown) when
+        writing to a sink that is not seekable. */
+    class PipeSink : public DataSink
+    {
+    public:
+        /// Writes to out, which must stay valid as long as the sink is used
+        PipeSink( std::ostream &out ) : m_out( out ), m_size( 0 ) { }
+
+        void writeAt( uint64 offset, const char *buffer, size_t bytes );
+
+        uint64 size( ) const { return m_size; }
+
+        bool isSeekable( ) const { return false; }
+
+        void flush( ) { m_out.flush( ); }
+
+    private:
+        PipeSink( const PipeSink & );
+        PipeSink &operator=( const PipeSink & );
+
+        std::ostream &m_out;
+        uint64 m_size;
+    };
+
+    /// Buffered std::streambuf reading from a DataSource
+    /** Allows the stream based header and event parsers to read from any DataSource. Seeking is supported. */
+    class SourceStreamBuf : public std::streambuf
+    {
+    public:
+        /// Read from source starting at offset
+        SourceStreamBuf( const DataSource &source, uint64 offset = 0 );
+
+    protected:
+        int_type underflow( );
+        pos_type seekoff( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which );
+        pos_type seekpos( pos_type pos, std::ios_base::openmode which );
+
+    private:
+        const DataSource &m_source;
+        std::vector<char> m_buffer;
+        uint64 m_base;      ///< source offset of the first byte in the buffer
+    };
+
+    /// Buffered std::streambuf writing to a DataSink
+    /** Allows the stream based header, record and event serialization to write to any DataSink. Seeking is supported
+        if the sink is seekable. */
+    class SinkStreamBuf : public std::streambuf
+    {
+    public:
+        /// Write to sink starting at offset
+        SinkStreamBuf( DataSink &sink, uint64 offset = 0 );
+
+        /// Destructor; writes buffered data
+        virtual ~SinkStreamBuf( );
+
+    protected:
+        int_type overflow( int_type c );
+        std::streamsize xsputn( const char *s, std::streamsize n );
+        int sync( );
+        pos_type seekoff( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which );
+        pos_type seekpos( pos_type pos, std::ios_base::openmode which );
+
+    private:
+        /// Write the buffer to the sink
+        void writeBuffer( );
+
+        DataSink &m_sink;
+        std::vector<char> m_buffer;
+        uint64 m_base;      ///< sink offset of the first byte in the buffer
+    };
+}
+
+#endif
@@ -20,6 +20,8 @@
 #define __EVENTHEADER_H_INCLUDED__
 
 #include "Types.h"
+#include <limits>
+#include <map>
 #include <vector>
 
 #define GDF_MAXNUM_EVENTS 16777215
@@ -45,6 +47,37 @@ namespace gdf
         };
     };
 
+    /// Structure-of-arrays copy of an event table
+    /** Element i of each column belongs to event i. channel and duration are only used in Mode 3; duration holds the raw
+        bits of Mode3Event::duration or Mode3Event::value.
+        EventHeader stores events as Mode1Event/Mode3Event arrays, which its accessors and the event index return by
+        reference, so EventColumns is an exchange format: getColumns() and setColumns() copy. Column access to the
+        events of a file without copies is provided by EventTableView (Reader::getEventTableView). */
+    struct EventColumns
+    {
+        std::vector<uint32> position;
+        std::vector<uint16> type;
+        std::vector<uint16> channel;
+        std::vector<uint32> duration;
+    };
+
+    /// Non-owning view of a sequence of event indices
+    /** Returned by the query functions of EventHeader. The view is invalidated when events are added, sorted or cleared. */
+    struct EventRange
+    {
+        EventRange( ) : first( NULL ), last( NULL ) { }
+        EventRange( const uint32 *f, const uint32 *l ) : first( f ), last( l ) { }
+
+        const uint32 *begin( ) const { return first; }
+        const uint32 *end( ) const { return last; }
+        size_t size( ) const { return last - first; }
+        bool empty( ) const { return first == last; }
+        uint32 operator[]( size_t i ) const { return first[i]; }
+
+        const uint32 *first;
+        const uint32 *last;
+    };
+
     /// Class that provides access to GDF events
     class EventHeader
     {
@@ -78,7 +111,20 @@ namespace gdf
 		uint32 secToPos( const double sample_time_sec );
 
 		// converts event position to time in seconds (0.0 sec corresponds to the main header start time)
-		double posToSec( const uint32 event_pos ) const;
+		double posToSec( const uint32 event_pos ) const { return posToSec( event_pos, m_efs ); }
+
+        /// Convert a one-based event position to time in seconds at event sampling rate efs
+        /** This is the conversion rule of all event position APIs. Valid positions are 1 to 2^31.
+            @throws exception::invalid_operation if efs is not positive or the position is not valid */
+        static double posToSec( const uint32 event_pos, const double efs )
+        {
+            if( efs <= 0 )
+                throw exception::invalid_operation( "Event table m_efs not set or not valid." );
+            // "-1" is for "one-based indexing" see EventHeader::secToPos
+            if( event_pos == 0 || event_pos - 1 > static_cast<uint32>( std::numeric_limits<int32>::max( ) ) )
+                throw exception::invalid_operation( "Event time < 0 [sec] not allowed." );
+            return ( event_pos - 1 ) * 1.0 / efs;
+        }
 
         /// returns event mode
         uint8 getMode( ) { return m_mode; }
@@ -98,10 +144,42 @@ namespace gdf
         /// Returns all Mode 3 Events
         std::vector<Mode3Event> getMode3Events () const;
 
+        /// Returns a reference to all Mode 1 Events
+        const std::vector<Mode1Event> &getMode1Events_readonly( ) const { return m_mode1; }
+
+        /// Returns a reference to all Mode 3 Events
+        const std::vector<Mode3Event> &getMode3Events_readonly( ) const { return m_mode3; }
+
         /// Returns indices of sparse samples associated with a channel
 		//    chan_idx is event.CHN from GDF spec (a 1-based index)
         std::vector<uint32> getSparseSamples (const size_t chan_idx);
 
+        /// Indices of the events of a type with begin_pos <= position < end_pos, ordered by position
+        /** Uses the event index, which is built on the first query after the events were modified. */
+        EventRange getEvents( uint16 type, uint32 begin_pos = 0, uint32 end_pos = 0xFFFFFFFF ) const;
+
+        /// Indices of the Mode 3 events of a type that are associated with a channel, ordered by position
+        /** channel is event.CHN from the GDF spec (1-based). Empty in Mode 1. */
+        EventRange getChannelEvents( uint16 type, uint16 channel, uint32 begin_pos = 0, uint32 end_pos = 0xFFFFFFFF ) const;
+
+        /// Indices of the sparse samples (NEQS events) of a channel, ordered by position
+        /** chan_idx is event.CHN from the GDF spec (1-based) */
+        EventRange getSparseSampleRange( uint16 chan_idx ) const { return getChannelEvents( 0x7fff, chan_idx ); }
+
+        /// Copy all events into columns
+        /** One pass over the events; see EventColumns. */
+        void getColumns( EventColumns &columns ) const;
+
+        /// Replace all events with copies of the events in columns
+        /** The columns must have equal length; channel and duration are required in Mode 3 and ignored in Mode 1.
+            Like all functions that replace events, this invalidates the event index; it is rebuilt on the next query.
+            @throws exception::invalid_operation */
+        void setColumns( const EventColumns &columns );
+
+        /// Build the event index now instead of on the first query
+        /** Queries build the index lazily, which is not thread safe. Call this before querying from several threads. */
+        void buildIndex( ) const;
+
         /// Returns a Mode 3 Event
         void getEvent( uint32 index, Mode3Event &ev );
 
@@ -124,6 +202,21 @@ namespace gdf
 
         std::vector<Mode1Event> m_mode1;
         std::vector<Mode3Event> m_mode3;
+
+        /// Position of event index in the current mode
+        uint32 getPosition( uint32 index ) const { return m_mode == 1 ? m_mode1[index].position : m_mode3[index].position; }
+
+        /// Narrow an index bucket to the events with begin_pos <= position < end_pos
+        EventRange findRange( const std::vector<uint32> &bucket, uint32 begin_pos, uint32 end_pos ) const;
+
+        /// Mark the event index as outdated
+        void invalidateIndex( ) { m_index_valid = false; }
+
+        typedef std::map< uint16, std::vector<uint32> > TypeIndex;
+        typedef std::map< std::pair<uint16,uint16>, std::vector<uint32> > ChannelIndex;
+        mutable bool m_index_valid;
+        mutable TypeIndex m_type_index;         /// event indices by type, ordered by position
+        mutable ChannelIndex m_channel_index;   /// Mode 3 event indices by (type,channel), ordered by position
     };
 }
 
@@ -0,0 +1,151 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#ifndef __EVENTTABLEVIEW_H_INCLUDED__
+#define __EVENTTABLEVIEW_H_INCLUDED__
+
+#include "EventHeader.h"
+#include "Types.h"
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace boost
+{
+    namespace interprocess
+    {
+        class file_mapping;
+        class mapped_region;
+    }
+}
+
+namespace gdf
+{
+    class DataSource;
+
+    /// Read-only view of one column of an event table in file representation
+    /** Elements are decoded from little endian when they are accessed. */
+    template<typename T>
+    class EventColumnView
+    {
+    public:
+        EventColumnView( ) : m_data( NULL ), m_size( 0 ) { }
+        EventColumnView( const char *data, size_t size ) : m_data( data ), m_size( size ) { }
+
+        /// Number of elements
+        size_t size( ) const { return m_size; }
+
+        /// Returns true if the column has no elements
+        bool empty( ) const { return m_size == 0; }
+
+        /// Decode element i
+        T operator[]( size_t i ) const
+        {
+            T value;
+            readLittleEndian( m_data + i * sizeof(T), value );
+            return value;
+        }
+
+        /// Decode elements [start,start+num) to out
+        void copy( T *out, size_t start, size_t num ) const
+        {
+            for( size_t i=0; i<num; i++ )
+                readLittleEndian( m_data + ( start + i ) * sizeof(T), out[i] );
+        }
+
+        /// File representation of the column
+        const char *data( ) const { return m_data; }
+
+    private:
+        const char *m_data;
+        size_t m_size;
+    };
+
+    /// Memory mapped, read-only view of the event table of a GDF file
+    /** Only the event table is mapped, and nothing is deserialized up front: the number of events, mode and sampling
+        rate are read from the 8 byte table header, and the columns are exposed as EventColumnView spans that decode
+        elements on access. Use this instead of EventHeader when only a few events or the event count are needed.
+      */
+    class EventTableView
+    {
+    public:
+        /// Map the event table that starts at offset in file filename
+        /** If the file ends at offset, the view contains no events.
+            @throws exception::serialization_error if the event table is truncated
+            @throws exception::invalid_eventmode */
+        EventTableView( const std::string &filename, uint64 offset );
+
+        /// View the event table that starts at offset in source
+        /** If the source is in memory the table is used in place, otherwise it is copied into the view.
+            @throws exception::serialization_error if the event table is truncated
+            @throws exception::invalid_eventmode */
+        EventTableView( const DataSource &source, uint64 offset );
+
+        /// Destructor
+        virtual ~EventTableView( );
+
+        /// Event mode (1 or 3)
+        uint8 getMode( ) const { return m_mode; }
+
+        /// Sampling rate associated with event positions
+        float32 getSamplingRate( ) const { return m_efs; }
+
+        /// Number of events
+        uint32 getNumEvents( ) const { return m_num_events; }
+
+        /// Event positions
+        const EventColumnView<uint32> &positions( ) const { return m_positions; }
+
+        /// Event types
+        const EventColumnView<uint16> &types( ) const { return m_types; }
+
+        /// Event channels. Empty in Mode 1.
+        const EventColumnView<uint16> &channels( ) const { return m_channels; }
+
+        /// Event durations or values. Empty in Mode 1.
+        const EventColumnView<uint32> &durations( ) const { return m_durations; }
+
+        /// Decode a single event as Mode 1 event (works in both modes)
+        void getEvent( uint32 index, Mode1Event &ev ) const;
+
+        /// Decode a single Mode 3 event
+        /** @throws exception::wrong_eventmode */
+        void getEvent( uint32 index, Mode3Event &ev ) const;
+
+    private:
+        EventTableView( const EventTableView &other );
+        EventTableView &operator=( const EventTableView &other );
+
+        /// Set up the columns from table, which holds available bytes
+        void init( const char *table, uint64 available );
+
+        boost::interprocess::file_mapping *m_mapping;
+        boost::interprocess::mapped_region *m_region;
+        std::vector<char> m_copy;   ///< Event table copied from a source that is not in memory
+
+        uint8 m_mode;
+        float32 m_efs;
+        uint32 m_num_events;
+        EventColumnView<uint32> m_positions;
+        EventColumnView<uint16> m_types;
+        EventColumnView<uint16> m_channels;
+        EventColumnView<uint32> m_durations;
+    };
+}
+
+#endif
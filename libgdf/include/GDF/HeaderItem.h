@@ -33,6 +33,13 @@
         private: \
         HeaderItem<TYPE,POS> NAME;
 
+#define GDF_DECLARE_HEADERITEM_NOTIFY( NAME, TYPE, POS, NOTIFY ) \
+        public: \
+        const TYPE &get_##NAME( ) const { return NAME.item; }; \
+        void set_##NAME( const TYPE &val ) { NAME.item = val; NOTIFY( ); }; \
+        private: \
+        HeaderItem<TYPE,POS> NAME;
+
 #define GDF_DECLARE_HEADERITEM_PRIVATE( NAME, TYPE, POS ) \
         public: \
         const TYPE &get_##NAME( ) const { return NAME.item; }; \
@@ -105,6 +112,8 @@ namespace gdf {
         //void fromstream( std::istream &in ) { in.read( reinterpret_cast<char*>(&item), sizeof(item) ); }
         void tostream( std::ostream & out ) const { writeLittleEndian( out, item ); }
         void fromstream( std::istream &in ) { readLittleEndian( in, item ); }
+        void tobuffer( char *out ) const { writeLittleEndian( out, item ); }
+        void frombuffer( const char *in ) { readLittleEndian( in, item ); }
         T item;
         size_t pos;
     };
@@ -132,6 +141,18 @@ namespace gdf {
                 readLittleEndian( in, item[i] );
         }
 
+        void tobuffer( char *out ) const
+        {
+            for(size_t i=0; i<L; i++)
+                writeLittleEndian( out + i*sizeof(T), item[i] );
+        }
+
+        void frombuffer( const char *in )
+        {
+            for(size_t i=0; i<L; i++)
+                readLittleEndian( in + i*sizeof(T), item[i] );
+        }
+
         T item[L];
         size_t pos, len;
     };
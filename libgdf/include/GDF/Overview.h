@@ -0,0 +1,122 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#ifndef __OVERVIEW_H_INCLUDED__
+#define __OVERVIEW_H_INCLUDED__
+
+#include "Types.h"
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace gdf
+{
+    class Reader;
+
+    /// Summary of a bin of consecutive samples
+    struct OverviewBin
+    {
+        float32 min;
+        float32 max;
+        float32 mean;
+    };
+
+    /// Multi-resolution min/max/mean overview of the signals of a GDF file
+    /** Level 0 summarizes bins of getBaseBinSize() samples, and each further level halves the number of bins, so the bins
+        of level k have getBaseBinSize() * 2^k samples. The top level has a single bin. Bins are in samples of the
+        respective channel, so channels with different sampling rates have pyramids of different depth. NaN samples are
+        ignored; a bin that contains only NaN samples is NaN.
+
+        The overview is computed by build() in a single pass over the data records and stored in a sidecar file, which
+        open() loads. Drawing a zoomed out view then costs O(pixels) instead of O(samples):
+        @code
+        Overview::build( reader, Overview::getSidecarName( filename ) );
+        Overview ov;
+        ov.open( Overview::getSidecarName( filename ) );
+        std::vector<OverviewBin> bins;
+        size_t bin_size = ov.query( channel, start, end, width, bins );
+        @endcode
+      */
+    class Overview
+    {
+    public:
+        /// Constructor
+        Overview( );
+
+        /// Destructor
+        virtual ~Overview( );
+
+        /// Compute the overview of all signals of an open Reader and write it to a sidecar file
+        /** Records are read through the Reader's staging buffer and do not enter the record cache.
+            @param[in] reader open Reader
+            @param[in] filename name of the sidecar file; an existing file is overwritten
+            @param[in] base_bin_size number of samples in a bin of level 0
+            @throws exception::serialization_error if the file can not be written
+          */
+        static void build( Reader &reader, const std::string &filename, size_t base_bin_size = 16 );
+
+        /// Default name of the sidecar file of a GDF file
+        static std::string getSidecarName( const std::string &gdf_filename ) { return gdf_filename + ".ovr"; }
+
+        /// Load an overview from a sidecar file
+        /** @throws exception::file_exists_not
+            @throws exception::serialization_error if the file is not a valid overview */
+        void open( const std::string &filename );
+
+        /// Number of channels
+        size_t getNumChannels( ) const { return m_channels.size( ); }
+
+        /// Number of samples in a bin of level 0
+        size_t getBaseBinSize( ) const { return m_base; }
+
+        /// Number of samples of a channel
+        uint64 getNumSamples( uint16 channel ) const;
+
+        /// Number of levels of a channel
+        size_t getNumLevels( uint16 channel ) const;
+
+        /// Number of samples in a bin of a level
+        size_t getBinSize( size_t level ) const { return m_base << level; }
+
+        /// Bins of a level of a channel
+        const std::vector<OverviewBin> &getLevel( uint16 channel, size_t level ) const;
+
+        /// Coarsest level that still has at least pixels bins in a range of num_samples samples
+        /** Returns level 0 if even level 0 has fewer bins; in that case drawing the raw samples is more accurate. */
+        size_t selectLevel( uint16 channel, uint64 num_samples, size_t pixels ) const;
+
+        /// Bins of the level selected for drawing samples [start,end) of a channel with pixels pixels
+        /** bins receives all bins of the selected level that overlap [start,end).
+            @return number of samples per bin */
+        size_t query( uint16 channel, uint64 start, uint64 end, size_t pixels, std::vector<OverviewBin> &bins ) const;
+
+    private:
+        struct ChannelOverview
+        {
+            uint64 num_samples;
+            std::vector< std::vector<OverviewBin> > levels;
+        };
+
+        const ChannelOverview &getChannel( uint16 channel ) const;
+
+        size_t m_base;
+        std::vector<ChannelOverview> m_channels;
+    };
+}
+
+#endif
@@ -19,8 +19,12 @@
 #ifndef __READER_H_INCLUDED__
 #define __READER_H_INCLUDED__
 
+#include "ChunkCursor.h"
 #include "Record.h"
+#include "RecordBlockHandler.h"
+#include "RecordStats.h"
 #include "EventHeader.h"
+#include "EventTableView.h"
 #include "GDFHeaderAccess.h"
 #include "Types.h"
 #include "tools.h"
@@ -30,10 +34,23 @@
 
 namespace gdf
 {
+    class DataSource;
+
+    enum ReaderFlags
+    {
+        reader_default      = 0,
+        reader_mmap         = 1,
+        reader_header_only  = 2
+    };
+
     /// Class for reading GDF files to disc.
     /** Data Records are only read on demand and stay in memory until another file is opened or the Reader object is destroyed.
         This cache can be disabled. Then each data record is loaded from disk everytime it is accessed. This saves memory, but may
-        severly decrease performance.
+        severly decrease performance. As a compromise, the cache size can be limited (see setMaxCacheRecords() and
+        setMaxCacheBytes()). When the limit is reached, records that have not been accessed recently are evicted.
+
+        Alternatively, the file can be memory mapped (see open()). Signals are then decoded directly from the mapped data
+        records and the record cache is not used; repeated access is served by the operating system's page cache.
       */
     class Reader
     {
@@ -45,7 +62,39 @@ namespace gdf
         virtual ~Reader( );
 
         /// Opens file for reading
-        void open( const std::string filename );
+        /** @param[in] filename Full path name to the file.
+            @param[in] flags reader_mmap maps the file into memory instead of reading records through a stream.
+                             reader_header_only parses the headers only; see openHeaderOnly().
+            @throws exception::file_exists_not
+        */
+        void open( const std::string filename, const int flags = reader_default );
+
+        /// Opens a GDF file from a data source
+        /** The source is not copied and must stay valid until the Reader is closed. If the source is in memory
+            (see DataSource::data()), data records are decoded in place as with reader_mmap. Record statistics
+            (getRecordStats()) are not available, because there is no file name to find the sidecar file.
+            @param[in] source data source, e.g. MemorySource or PipeSource
+            @param[in] flags reader_header_only parses the headers only; reader_mmap is ignored.
+            @throws exception::serialization_error if the headers can not be read
+        */
+        void open( const DataSource &source, const int flags = reader_default );
+
+        /// Opens file for reading header information
+        /** Parses main, signal and tag headers but allocates nothing that scales with the number of data records
+            or the size of a record: the record cache, the uncached record and the read-ahead thread are set up
+            on the first access to data records. Events can be read as usual.
+            @param[in] filename Full path name to the file.
+            @throws exception::file_exists_not
+        */
+        void openHeaderOnly( const std::string filename ) { open( filename, reader_header_only ); }
+
+        /// Read the headers of a file without opening it
+        /** Parses main, signal and tag headers into header and closes the file again. Sampling rates are set as by open().
+            @param[in] filename Full path name to the file.
+            @param[out] header receives the headers
+            @throws exception::file_exists_not
+        */
+        static void peekHeader( const std::string &filename, GDFHeaderAccess &header );
 
         /// Close file
         void close( );
@@ -53,6 +102,65 @@ namespace gdf
         /// Enable or disable cache
         void enableCache( bool b );
 
+        /// Limit the number of records kept in the cache.
+        /** When the limit is reached, cached records are evicted in CLOCK (second chance) order.
+            @param[in] num maximum number of cached records; 0 means no limit (default).
+          */
+        void setMaxCacheRecords( size_t num );
+
+        /// Limit the memory used by cached records.
+        /** A cached record takes approximately as much memory as it takes on disk, so the byte budget
+            is converted to a number of records. At least one record is always cached.
+            @param[in] bytes maximum number of bytes in cached records; 0 means no limit (default).
+          */
+        void setMaxCacheBytes( size_t bytes );
+
+        /// Returns the number of records currently held in the cache
+        size_t getNumCachedRecords( ) const { return m_cache_entries.size( ); }
+
+        /// Returns the number of record accesses served from the cache
+        size_t getCacheHits( ) const { return m_cache_hits; }
+
+        /// Returns the number of record accesses that had to be read from disk
+        size_t getCacheMisses( ) const { return m_cache_misses; }
+
+        /// Reset cache hit and miss counters
+        void resetCacheStatistics( );
+
+        /// Enable or disable projected reads
+        /** When enabled, getSignals() and getSignal() read only the byte ranges of the requested channels from
+            each data record instead of complete records. Ranges of channels that are adjacent in the record are
+            read together. Records that are already in the cache are still taken from the cache, but projected
+            records are not added to it. Has no effect if the file is memory mapped.
+          */
+        void enableProjection( bool b ) { m_projection_enabled = b; }
+
+        /// Set the number of threads used by getSignals() and getSignal()
+        /** With more than one thread, records are loaded in blocks on the calling thread and decoded by a pool of
+            worker threads, either split into ranges of records or, for short ranges, into groups of channels. The next
+            block is loaded while the current one is decoded. Parallel decoding works on the file representation of
+            the records (memory mapping or block reads) and bypasses the record cache. The pool is started here and
+            stopped by close(); it is restarted on demand.
+            @param[in] num number of threads; 1 decodes on the calling thread (default), 0 uses one thread per processor core.
+          */
+        void setNumThreads( size_t num );
+
+        /// Returns the number of threads used by getSignals() and getSignal()
+        size_t getNumThreads( ) const { return m_num_threads; }
+
+        /// Enable or disable background read-ahead
+        /** When records are accessed in order through getRecordPtr() or readRecord() (this includes getSignals(),
+            getSignal() and getSample() with the cache enabled), a background thread reads and decodes the next
+            depth records with positional reads, so that I/O overlaps with the caller's processing. Read-ahead
+            starts at the second consecutive record and is reset by any non-sequential access. Prefetched records
+            are moved into the cache when they are accessed. Has no effect if the file is memory mapped.
+            @param[in] depth number of records to read ahead; 0 disables read-ahead (default).
+          */
+        void enablePrefetch( size_t depth );
+
+        /// Returns the number of cache misses that were served by read-ahead
+        size_t getPrefetchHits( ) const { return m_prefetch_hits; }
+
         /// Set cache to the correct size
         virtual void initCache( );
 
@@ -71,6 +179,74 @@ namespace gdf
           */
         void getSignals( std::vector< std::vector<double> > &buffer, double start_time = 0, double end_time = -1, std::vector<uint16> signal_indices = std::vector<uint16>() );
 
+        /// Read Signals from file into a caller owned buffer (physical units)
+        /** Sample n of the i-th requested signal is written to buffer[i*channel_stride + n*sample_stride]. For a
+            channel-major matrix use channel_stride = number of samples and sample_stride = 1; for frame-interleaved
+            (sample-major) data use channel_stride = 1 and sample_stride = number of signals. The buffer must be large
+            enough for getNumSamples() samples of each requested signal.
+            @param[out] buffer pointer to the first sample of the first signal
+            @param[in] channel_stride distance between the first samples of consecutive signals
+            @param[in] sample_stride distance between consecutive samples of a signal
+            @param[in] start_time samples with n >= start_time*fs are loaded.
+            @param[in] end_time samples with n < end_time*fs are loaded. end_time = -1 loads the complete signal.
+            @param[in] signal_indices vector with signal indices that should be loaded. If empty, all signals are loaded.
+          */
+        void getSignals( float32 *buffer, size_t channel_stride, size_t sample_stride, double start_time = 0, double end_time = -1, std::vector<uint16> signal_indices = std::vector<uint16>() );
+
+        /// Read Signals from file into a caller owned buffer (physical units)
+        /** See getSignals( float32*, size_t, size_t, double, double, std::vector<uint16> ) */
+        void getSignals( float64 *buffer, size_t channel_stride, size_t sample_stride, double start_time = 0, double end_time = -1, std::vector<uint16> signal_indices = std::vector<uint16>() );
+
+        /// Read Signals from file in their raw (digital) representation
+        /** No scaling is applied; the samples are copied as stored in the file. T must be the data type of all requested
+            signals, otherwise exception::bad_type_assigned_to_channel is thrown. Supported for all GDF data types.
+            Parameters are the same as in getSignals( std::vector< std::vector<double> >&, ... ).
+          */
+        template<typename T> void getSignalsRaw( std::vector< std::vector<T> > &buffer, double start_time = 0, double end_time = -1, std::vector<uint16> signal_indices = std::vector<uint16>() );
+
+        /// Read Signals from file in their raw representation into a caller owned buffer
+        /** Layout as in getSignals( float32*, size_t, size_t, ... ), type requirements as in getSignalsRaw(). */
+        template<typename T> void getSignalsRaw( T *buffer, size_t channel_stride, size_t sample_stride, double start_time = 0, double end_time = -1, std::vector<uint16> signal_indices = std::vector<uint16>() );
+
+        /// Read a single signal in its raw representation into a buffer
+        /** Parameters are the same as in getSignal(), type requirements as in getSignalsRaw(). */
+        template<typename T> void getSignalRaw( uint16 channel_idx, T *buffer, size_t start = 0, size_t end = 0 );
+
+        /// Create a cursor over successive windows of the given channels
+        /** See ChunkCursor. The reader must stay open while the cursor is used.
+            @param[in] signal_indices channels to read. If empty, all signals are read.
+            @param[in] chunk_samples window length in samples
+            @param[in] hop distance between the starts of consecutive windows. hop = 0 means hop = chunk_samples.
+          */
+        ChunkCursor scan( const std::vector<uint16> &signal_indices, size_t chunk_samples, size_t hop = 0 );
+
+        /// Extract event-locked epochs of equally sampled signals
+        /** For each event position p (in samples of the event table sampling rate, as stored in Mode1Event and
+            Mode3Event) the samples [n-pre, n+post) are extracted, where n is the sample at the time of the event,
+            pre = round(pre_time*fs) and post = round(post_time*fs). The result is a dense epochs x channels x samples
+            array: sample s of channel i in epoch e is stored in buffer[(e*num_channels + i)*num_samples + s].
+            Samples outside the recording are set to NaN.
+            The records touched by all epochs are determined once and every record is read and decoded once, even
+            if epochs overlap.
+            @param[out] buffer resized to positions.size() * num_channels * num_samples
+            @param[in] positions event positions
+            @param[in] pre_time length of the epoch before the event in seconds
+            @param[in] post_time length of the epoch after the event in seconds
+            @param[in] signal_indices channels to extract. If empty, all signals are extracted.
+            @return number of samples per epoch and channel
+            @throws exception::invalid_operation if the channels have different sampling rates
+          */
+        size_t getEpochs( std::vector<double> &buffer, const std::vector<uint32> &positions, double pre_time, double post_time,
+                          std::vector<uint16> signal_indices = std::vector<uint16>() );
+
+        /// Extract epochs locked to all events of a type
+        /** Epochs are ordered by event position. See getEpochs( std::vector<double>&, const std::vector<uint32>&, ... ). */
+        size_t getEpochs( std::vector<double> &buffer, uint16 event_type, double pre_time, double post_time,
+                          std::vector<uint16> signal_indices = std::vector<uint16>() );
+
+        /// Number of samples getSignals() returns for a channel and time range
+        size_t getNumSamples( uint16 channel_idx, double start_time = 0, double end_time = -1 ) const;
+
         /// Read a single channel from file into buffer.
         /** The buffer must be allocated by the user, who is also responsible that enough memory is allocated.
             @param[in] channel_idx index of channel to read
@@ -83,10 +259,14 @@ namespace gdf
         /// Read a single Sample (physical units)
         /** @param[in] channel_idx channel index
             @param[in] sample_idx sample index
+            @throws exception::index_out_of_range if sample_idx is past the end of the channel
           */
         double getSample( uint16 channel_idx, size_t sample_idx );
 
         /// Returns a reference to Record
+        /** If the cache is disabled or the file is memory mapped, the same Record instance is reused
+            for every call, so the pointer is only valid until the next call. If the cache size is limited,
+            the Record may be evicted and reused by later calls. */
         Record *getRecordPtr( size_t index );
 
         /// Read directly into Record rec
@@ -95,9 +275,31 @@ namespace gdf
         /// Precache a range of Records
         void precacheRecords( size_t start, size_t end );
 
+        /// Precache an arbitrary set of Records
+        /** The missing records are read with DataSource::readBatch(), so that they can be read concurrently
+            (see FileSource). Runs of consecutive records are read as one request. If the cache size is limited,
+            records are read in batches that fit into the cache, and earlier batches may be evicted by later ones.
+            Records that have already been read ahead are taken over instead of being read again.
+            Has no effect if the cache is disabled or the file is memory mapped.
+            @param[in] indices indices of the records; order and duplicates do not matter
+            @throws exception::index_out_of_range */
+        void precacheRecords( const std::vector<size_t> &indices );
+
         /// get reference to event header
         EventHeader *getEventHeader( );
 
+        /// get a memory mapped view of the event table
+        /** Unlike getEventHeader(), the event table is not deserialized; see EventTableView. The view is created on
+            the first call and stays valid until the file is closed. */
+        const EventTableView &getEventTableView( );
+
+        /// get the per-record statistics index of the file
+        /** The index is loaded from the sidecar file RecordStatsIndex::getSidecarName( filename ) on the first call
+            and stays valid until the file is closed.
+            @throws exception::file_exists_not if the file has no index; see RecordStatsIndex::build()
+            @throws exception::serialization_error if the index is invalid or does not match the file */
+        const RecordStatsIndex &getRecordStats( );
+
         /// get Constant reference to header access
         const GDFHeaderAccess &getHeaderAccess_readonly( ) const { return m_header; }
 
@@ -113,22 +315,203 @@ namespace gdf
         */
 		void eventToSample( double& sample_time_sec, double& sample_physical_value, const Mode3Event& ev ) ;
 
+        /// Decode all samples of a sparse (NEQS) channel in one pass
+        /** Equivalent to calling eventToSample() for each NEQS event of the channel, ordered by position, but uses the
+            event index and the precomputed calibration of the signal header.
+            @param[in] channel_idx 0-based signal index (event.CHN - 1)
+            @param[out] times sample times in seconds
+            @param[out] values physical sample values
+            @throws exception::event_conversion_error if the channel is not a NEQS channel or has an invalid data type
+          */
+        void getSparseSignal( uint16 channel_idx, std::vector<double> &times, std::vector<double> &values );
+
+        /// Decode the samples of all sparse (NEQS) channels
+        /** times[i] and values[i] hold the samples of signal i; they are empty for channels with samples_per_record > 0. */
+        void getSparseSignals( std::vector< std::vector<double> > &times, std::vector< std::vector<double> > &values );
+
+        /// Returns true if the data records are decoded in place from a memory mapping or an in-memory source
+        bool isMemoryMapped( ) const { return m_mapped_records != NULL; }
 
     protected:
+        class Prefetcher;
+        class WorkerPool;
+        friend class ChunkCursor;
+        friend class ConcurrentReader;
+        friend class Overview;
+        friend class RecordStatsIndex;
+
         void readEvents( );
 
+        /// Start or stop the prefetcher according to m_prefetch_depth
+        void restartPrefetcher( );
+
+        /// Set up the record cache and read-ahead if the file was opened with reader_header_only
+        void prepareRecordAccess( ) { if( !m_records_ready ) initRecordAccess( ); }
+
+        /// Set up the record cache and read-ahead
+        void initRecordAccess( );
+
+        /// Delete cached records and free the cache
+        void releaseCache( );
+
+        /// Compute the sampling rate of each signal from the record duration
+        static void initSampleRates( GDFHeaderAccess &header );
+
+        /// Number of bytes read at once when loading blocks of data records
+        static const size_t RECORD_BLOCK_SIZE = 4*1024*1024;
+
+        /// Number of records of record_length bytes that are read at once; at least one
+        static size_t getBlockRecords( size_t record_length );
+
+        /// Take record index from the prefetcher if it has been read ahead
+        Record *takePrefetched( size_t index );
+
+        /// Parse the headers from source and set up record access according to flags
+        /** If owns_source is true, the Reader deletes source when it is closed, also if opening fails. */
+        void openSource( const DataSource *source, bool owns_source, const int flags );
+
+        /// Close the data source, or unmap it if it is memory mapped
+        void releaseSource( );
+
+        /// Maximum number of records in the cache (0 if unlimited)
+        size_t getCacheCapacity( ) const;
+
+        /// Get an empty Record for the cache entry of record index. Evicts another entry if the cache is full.
+        Record *insertCacheEntry( size_t index );
+
+        /// Evict one entry from the cache and return its Record for reuse
+        Record *evictCacheEntry( );
+
+        /// Evict entries until the cache size is within its capacity
+        void shrinkCache( );
+
+        /// Pointer to the file representation of data record index
+        /** Records are served from the memory mapping, or from the staging buffer. If the record is not in the
+            staging buffer, a block of records starting with index (but not beyond end) is read with a single read.
+            The pointer is valid until the next call. */
+        const char *getRawRecord( size_t index, size_t end );
+
+        /// Read num records starting with start into the staging buffer with a single read
+        void readRecordBlock( size_t start, size_t num );
+
+        /// Returns true if getSignals() and getSignal() should read projected records
+        bool useProjection( ) const { return m_projection_enabled && !isMemoryMapped( ); }
+
+        /// Compute the sorted and coalesced byte ranges [first,second) that the given signals occupy in a record
+        void computeProjection( const std::vector<uint16> &signal_indices, std::vector< std::pair<size_t,size_t> > &ranges ) const;
+
+        /// Read only the given byte ranges of record index
+        /** The ranges are placed at their offsets in a record sized buffer, so the result can be decoded like a
+            complete record as long as only the projected channels are accessed. The pointer is valid until the next call. */
+        const char *readProjectedRecord( size_t index, const std::vector< std::pair<size_t,size_t> > &ranges );
+
+        /// Fill in all signals if signal_indices is empty, and compute the sample range [start,end) of each signal
+        void computeSignalRanges( double start_time, double end_time, std::vector<uint16> &signal_indices, std::vector<size_t> &start, std::vector<size_t> &end ) const
+        {
+            computeSignalRanges( m_header, start_time, end_time, signal_indices, start, end );
+        }
+
+        /// computeSignalRanges() for the signals of header. Ranges are clamped to the data records, so end[i] >= start[i].
+        static void computeSignalRanges( const GDFHeaderAccess &header, double start_time, double end_time, std::vector<uint16> &signal_indices,
+                                         std::vector<size_t> &start, std::vector<size_t> &end );
+
+        /// Compute the range of records [first,last) that contains the sample ranges [start,end)
+        void computeRecordRange( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end, size_t &first, size_t &last ) const
+        {
+            computeRecordRange( m_header, signal_indices, start, end, first, last );
+        }
+
+        /// computeRecordRange() for the signals of header. first >= last if all ranges are empty.
+        static void computeRecordRange( const GDFHeaderAccess &header, const std::vector<uint16> &signal_indices, const std::vector<size_t> &start,
+                                        const std::vector<size_t> &end, size_t &first, size_t &last );
+
+        /// Implementation of the caller-buffer getSignals()
+        template<typename U> void getSignalsStrided( U *buffer, size_t channel_stride, size_t sample_stride, double start_time, double end_time, std::vector<uint16> signal_indices );
+
+        /// Read samples [start,end) of equally sampled signals to out[i] without using the record cache
+        void readWindow( const std::vector<uint16> &signal_indices, size_t start, size_t end, double *const *out );
+
+        /// Read samples [start[i],end[i]) of each signal to out[i] without using the record cache
+        void readWindow( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end, double *const *out );
+
+        /// Pass all records of all signals to handler in blocks, without using the record cache
+        /** A block holds at most a fixed number of samples of all channels together, but at least one record. */
+        void readRecordBlocks( RecordBlockHandler &handler );
+
+        /// Throws exception::bad_type_assigned_to_channel if a signal is not of the given data type
+        void checkDatatype( const std::vector<uint16> &signal_indices, uint32 datatype ) const;
+
+        /// Read samples [start,end) of the given signals; sample n of signal i goes to out[i][(n-start[i])*stride]
+        /** Samples are converted to physical units, or copied unmodified if RAW is true. */
+        template<typename U, bool RAW> void readSignals( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end,
+                                                         U *const *out, size_t stride, bool use_cache = true );
+
+        /// A part of a parallel decode: records [rec_begin,rec_end) of channels [ch_begin,ch_end)
+        template<typename U> struct RecordDecodeTask
+        {
+            const char *records;    /// File representation of record first_record and following records
+            size_t first_record;
+            size_t rec_begin, rec_end;
+            size_t ch_begin, ch_end;
+            const std::vector<uint16> *signal_indices;
+            const std::vector<size_t> *start;   /// First sample of each channel that is written to out
+            const std::vector<size_t> *end;     /// End sample of each channel
+            U *const *out;          /// Output buffer of each channel
+            size_t stride;          /// Distance between consecutive output samples
+        };
+
+        /// Decode the samples of a RecordDecodeTask that fall into [start,end) of each channel
+        template<typename U, bool RAW> void decodeRecords( const RecordDecodeTask<U> &task ) const;
+
+        /// Queue the decoding of records [rec_begin,rec_end) on the worker pool; the caller waits for it
+        template<typename U, bool RAW> void decodeRecordsParallel( const char *records, size_t rec_begin, size_t rec_end, const std::vector<uint16> &signal_indices,
+                                                         const std::vector<size_t> &start, const std::vector<size_t> &end, U *const *out, size_t stride ) const;
+
+        /// Load and decode the requested sample ranges of the given channels in parallel
+        template<typename U, bool RAW> void readSignalsParallel( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end,
+                                                       U *const *out, size_t stride );
+
+        /// Convert samples of a channel from the file representation of a record to physical units, or copy them if RAW is true
+        template<typename U, bool RAW> void deblitRawSamples( uint16 channel_idx, const char *record, U *buffer, size_t start, size_t num, size_t stride = 1 ) const;
+
         std::string m_filename;
         GDFHeaderAccess m_header;
         EventHeader *m_events;
+        EventTableView *m_event_view;
+        RecordStatsIndex *m_record_stats;
         std::vector< Record* > m_record_cache;
         Record* m_record_nocache;
         std::list<size_t> m_cache_entries;
-        std::ifstream m_file;
+        std::vector<bool> m_cache_referenced;   /// CLOCK reference bit for each cached record
+        size_t m_cache_max_records;
+        size_t m_cache_max_bytes;
+        size_t m_cache_hits;
+        size_t m_cache_misses;
+        const DataSource *m_source;
+        bool m_owns_source;
         bool m_cache_enabled;
+        bool m_records_ready;   /// false after opening with reader_header_only until records are first accessed
 
         size_t m_record_length; /// Record length in bytes
         size_t m_record_offset; /// Where data records start in the file
         size_t m_event_offset;  /// Where the event table starts in the file
+        std::vector<size_t> m_channel_offset;   /// Where each channel starts within a record
+
+        std::vector<char> m_record_buffer;  /// Staging buffer for block reads
+        size_t m_buffer_first;  /// Index of the first record in the staging buffer
+        size_t m_buffer_num;    /// Number of records in the staging buffer
+
+        bool m_projection_enabled;
+        size_t m_num_threads;
+
+        Prefetcher *m_prefetcher;
+        WorkerPool *m_workers;  /// Decodes record blocks if m_num_threads > 1
+        size_t m_prefetch_depth;
+        size_t m_prefetch_hits;
+        std::vector<char> m_projection_buffer;  /// Record sized buffer for projected reads
+        std::vector<char> m_batch_buffer;   /// Staging buffer for batched reads of scattered records
+
+        const char *m_mapped_records;   /// Start of the data records if the source is in memory
     };
 }
 
@@ -66,6 +66,9 @@ namespace gdf {
         /// Returns reference to channel chan_idx.
         Channel *getChannel( const size_t chan_idx );
 
+        /// Read all channels from a memory buffer that holds one data record as stored in the file.
+        void frombuffer( const char *in );
+
         friend std::ostream &operator<<( std::ostream &out, const Record &c );
         friend std::istream &operator>>( std::istream &in, Record &c );
 
@@ -0,0 +1,41 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#ifndef __RECORDBLOCKHANDLER_H_INCLUDED__
+#define __RECORDBLOCKHANDLER_H_INCLUDED__
+
+#include <vector>
+#include <stddef.h>
+
+namespace gdf
+{
+    /// Receives all records of a file in blocks, see Reader::readRecordBlocks()
+    class RecordBlockHandler
+    {
+    public:
+        /// Destructor
+        virtual ~RecordBlockHandler( ) { }
+
+        /// Process records [first_record,first_record+num_records)
+        /** Samples are in physical units. channels[i] points to the samples of signal i in the block,
+            or is NULL if the signal has no samples per record. */
+        virtual void processBlock( size_t first_record, size_t num_records, const std::vector<double*> &channels ) = 0;
+    };
+}
+
+#endif
@@ -68,6 +68,12 @@ namespace gdf
         /// Unegister Callback for record full event
         void unregisterRecordFullCallback( RecordFullHandler *h );
 
+        /// Clamp out of range physical samples instead of throwing.
+        void enableSaturation( bool b ) { m_saturate = b; }
+
+        /// Returns true if out of range physical samples are clamped.
+        bool getSaturation( ) const { return m_saturate; }
+
         /// Add a physical sample to the channel specified by channel_idx.
         void addSamplePhys( const size_t channel_idx, const double value );
 
@@ -148,6 +154,7 @@ namespace gdf
         size_t m_num_full, m_num_recs;
         std::vector< std::list< Record* >::iterator > m_channelhead;
         std::list<RecordFullHandler*> m_recfull_callbacks;
+        bool m_saturate;
     };
 }
 
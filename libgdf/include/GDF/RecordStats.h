@@ -0,0 +1,119 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#ifndef __RECORDSTATS_H_INCLUDED__
+#define __RECORDSTATS_H_INCLUDED__
+
+#include "RecordBlockHandler.h"
+#include "Types.h"
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace gdf
+{
+    class GDFHeaderAccess;
+    class Reader;
+    class Record;
+
+    /// Summary statistics of the samples of one channel in one data record
+    /** NaN samples are counted in nan_count and otherwise ignored. If all samples are NaN, min, max, mean and rms are NaN. */
+    struct RecordStat
+    {
+        float32 min;
+        float32 max;
+        float32 mean;
+        float32 rms;
+        uint32 nan_count;
+    };
+
+    /// Index of per-record, per-channel summary statistics of a GDF file
+    /** The index is stored in a small sidecar file next to the GDF file and allows screening a recording (flat
+        channels, clipping, dropouts) without decoding the data records.
+        It is built either while writing (Writer::enableRecordStats) or in one pass over an existing file (build()),
+        and is read with Reader::getRecordStats().
+      */
+    class RecordStatsIndex : private RecordBlockHandler
+    {
+    public:
+        /// Constructor
+        RecordStatsIndex( );
+
+        /// Destructor
+        virtual ~RecordStatsIndex( );
+
+        /// Default name of the sidecar file of a GDF file
+        static std::string getSidecarName( const std::string &gdf_filename ) { return gdf_filename + ".rsi"; }
+
+        /// Remove all records and take the channel layout from a header
+        void reset( const GDFHeaderAccess &header );
+
+        /// Append the statistics of a full record
+        void addRecord( Record *rec );
+
+        /// Replace the index with the statistics of all records of an open Reader
+        /** Records are read through the Reader's staging buffer and do not enter the record cache. */
+        void build( Reader &reader );
+
+        /// Write the index to a file
+        /** @throws exception::serialization_error */
+        void save( const std::string &filename ) const;
+
+        /// Load the index from a file
+        /** @throws exception::file_exists_not
+            @throws exception::serialization_error if the file is not a valid index */
+        void load( const std::string &filename );
+
+        /// Check that the index describes a file with this header
+        /** True if the number of records and the samples per record of each channel match. */
+        bool matches( const GDFHeaderAccess &header ) const;
+
+        /// Number of indexed records
+        size_t getNumRecords( ) const { return m_num_records; }
+
+        /// Number of channels
+        size_t getNumChannels( ) const { return m_spr.size( ); }
+
+        /// Number of samples per record of a channel
+        size_t getSamplesPerRecord( uint16 channel ) const;
+
+        /// Statistics of a channel in a record
+        /** @throws exception::index_out_of_range
+            @throws exception::nonexistent_channel_access */
+        const RecordStat &get( size_t record, uint16 channel ) const;
+
+        /// Combined statistics of a channel over records [first_record, last_record)
+        RecordStat getSummary( uint16 channel, size_t first_record, size_t last_record ) const;
+
+        /// Combined statistics of a channel over all records
+        RecordStat getSummary( uint16 channel ) const { return getSummary( channel, 0, m_num_records ); }
+
+    private:
+        static RecordStat computeStat( const double *samples, size_t num );
+
+        /// Append the statistics of a block of records read by build()
+        void processBlock( size_t first_record, size_t num_records, const std::vector<double*> &channels );
+
+        std::vector<size_t> m_spr;
+        size_t m_num_records;
+        std::vector<RecordStat> m_stats;    ///< record major: m_stats[record*num_channels+channel]
+        std::vector<double> m_scratch;
+    };
+}
+
+#endif
@@ -33,10 +33,10 @@ namespace gdf
         GDF_DECLARE_HEADERSTRING( transducer_type, 16, 80)
         GDF_DECLARE_HEADERSTRING( physical_dimension, 96, 6)  // the spec defines this as a 6 byte long char[8]
         GDF_DECLARE_HEADERITEM( physical_dimension_code, uint16, 102 )
-        GDF_DECLARE_HEADERITEM( physmin, float64, 104 )
-        GDF_DECLARE_HEADERITEM( physmax, float64, 112 )
-        GDF_DECLARE_HEADERITEM( digmin, float64, 120 )
-        GDF_DECLARE_HEADERITEM( digmax, float64, 128 )
+        GDF_DECLARE_HEADERITEM_NOTIFY( physmin, float64, 104, updateCalibration )
+        GDF_DECLARE_HEADERITEM_NOTIFY( physmax, float64, 112, updateCalibration )
+        GDF_DECLARE_HEADERITEM_NOTIFY( digmin, float64, 120, updateCalibration )
+        GDF_DECLARE_HEADERITEM_NOTIFY( digmax, float64, 128, updateCalibration )
         GDF_DECLARE_RESERVED( reserved_1, 136, 68 )
         GDF_DECLARE_HEADERITEM( lowpass, float32, 204 )
         GDF_DECLARE_HEADERITEM( highpass, float32, 208 )
@@ -141,16 +141,34 @@ namespace gdf
         void copyFrom( const SignalHeader &other );
 
         /// Converts from physical units to raw digital representation
-        double phys_to_raw( const double phy ) const;
+        double phys_to_raw( const double phy ) const { return phy * m_phys_to_raw_scale + m_phys_to_raw_offset; }
 
         /// Converts from raw digital representation to physical units
-        double raw_to_phys( const double raw ) const;
+        double raw_to_phys( const double raw ) const { return raw * m_raw_to_phys_scale + m_raw_to_phys_offset; }
+
+        /// Scale of the affine transform raw -> phys: phys = raw * scale + offset
+        /** The calibration is recomputed whenever physmin, physmax, digmin or digmax change. */
+        double getRawToPhysScale( ) const { return m_raw_to_phys_scale; }
+
+        /// Offset of the affine transform raw -> phys: phys = raw * scale + offset
+        double getRawToPhysOffset( ) const { return m_raw_to_phys_offset; }
+
+        /// Scale of the affine transform phys -> raw: raw = phys * scale + offset
+        double getPhysToRawScale( ) const { return m_phys_to_raw_scale; }
+
+        /// Offset of the affine transform phys -> raw: raw = phys * scale + offset
+        double getPhysToRawOffset( ) const { return m_phys_to_raw_offset; }
 
         void set_samplerate( uint32 fs ) { samplerate = fs; }
         uint32 get_samplerate( ) const { return samplerate; }
 
     private:
+        /// Recompute the cached affine calibration from physmin, physmax, digmin and digmax
+        void updateCalibration( );
+
         uint32 samplerate;
+        double m_raw_to_phys_scale, m_raw_to_phys_offset;
+        double m_phys_to_raw_scale, m_phys_to_raw_offset;
 
         friend class GDFHeaderAccess;
         friend std::ostream& operator<< (std::ostream& out, const GDFHeaderAccess& hdr);
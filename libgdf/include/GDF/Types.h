@@ -23,6 +23,7 @@
 #include <boost/cstdint.hpp>
 #include <boost/predef/other/endian.h>
 #include <iostream>
+#include <string.h>
 
 namespace gdf
 {
@@ -55,6 +56,19 @@ namespace gdf
 
     size_t datatype_size( uint32 t );
 
+    /// GDF type id of the sample type T
+    template<typename T> uint32 datatype_id( );
+    template<> inline uint32 datatype_id<int8>( ) { return INT8; }
+    template<> inline uint32 datatype_id<uint8>( ) { return UINT8; }
+    template<> inline uint32 datatype_id<int16>( ) { return INT16; }
+    template<> inline uint32 datatype_id<uint16>( ) { return UINT16; }
+    template<> inline uint32 datatype_id<int32>( ) { return INT32; }
+    template<> inline uint32 datatype_id<uint32>( ) { return UINT32; }
+    template<> inline uint32 datatype_id<int64>( ) { return INT64; }
+    template<> inline uint32 datatype_id<uint64>( ) { return UINT64; }
+    template<> inline uint32 datatype_id<float32>( ) { return FLOAT32; }
+    template<> inline uint32 datatype_id<float64>( ) { return FLOAT64; }
+
     template<typename T>
     T switch_endian( const T &source )
     {
@@ -85,6 +99,20 @@ namespace gdf
 #endif
     }
 
+    template<typename T>
+    void writeLittleEndian( char *out, T item )
+    {
+#if BOOST_ENDIAN_LITTLE_BYTE
+        memcpy( out, &item, sizeof(item) );
+#elif BOOST_ENDIAN_BIG_BYTE
+        const char* p = reinterpret_cast<const char*>(&item) + sizeof(item)-1;
+        for( size_t i=0; i<sizeof(item); i++ )
+            out[i] = *p--;
+#else
+    #error "Unable to determine system endianness."
+#endif
+    }
+
     template<typename T>
     void readLittleEndian( std::istream &in, T &item )
     {
@@ -99,6 +127,20 @@ namespace gdf
 #endif
     }
 
+    template<typename T>
+    void readLittleEndian( const char *in, T &item )
+    {
+#if BOOST_ENDIAN_LITTLE_BYTE
+        memcpy( &item, in, sizeof(item) );
+#elif BOOST_ENDIAN_BIG_BYTE
+        char* p = reinterpret_cast<char*>(&item) + sizeof(item)-1;
+        for( size_t i=0; i<sizeof(item); i++ )
+            *p-- = in[i];
+#else
+    #error "Unable to determine system endianness."
+#endif
+    }
+
 }
 
 #endif
@@ -22,14 +22,19 @@
 #include "RecordBuffer.h"
 #include "RecordFullHandler.h"
 #include "EventHeader.h"
+#include "RecordStats.h"
 #include "GDFHeaderAccess.h"
 #include <string>
+#include <list>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
 namespace gdf
 {
+    class DataSink;
+    class SinkStreamBuf;
+
     enum WriterFlags
     {
         writer_ev_file      = 0,
@@ -72,6 +77,17 @@ namespace gdf
         */
         void open( const std::string filename, const int flags = writer_ev_file );
 
+        /// Opens sink for writing and writes Header
+        /** The sink is borrowed and must outlive the writer or the next call to close(). Events are always
+            buffered in memory and no record statistics index is written. If the sink is not seekable, the
+            number of data records in the header is left at -1 (unknown).
+            @param[in] sink Destination of the GDF data
+            @param[in] flags Flags...
+            @throws exception::header_issues
+            @throws exception::file_open
+        */
+        void open( DataSink &sink, const int flags = writer_ev_memory );
+
         /// Close file.
         /** File is closed if open. Prior to closing, events are written to the file. */
         void close( );
@@ -88,6 +104,19 @@ namespace gdf
         /** @param[in] num number of records */
         void setMaxFullRecords( size_t num );
 
+        /// Enable or disable saturation of physical samples.
+        /** By default physical samples that do not fit into the channel's data type cause boost::numeric::bad_numeric_cast
+            to be thrown. With saturation enabled they are clamped to the data type's range instead.
+            @param[in] b true to enable saturation */
+        void enableSaturation( bool b );
+
+        /// Enable or disable building a per-record statistics index while writing.
+        /** The index is written to RecordStatsIndex::getSidecarName( filename ) when the file is closed.
+            Must be set before opening the file.
+            @param[in] b true to enable the index
+            @throws exception::file_open */
+        void enableRecordStats( bool b );
+
         /// Create a signal.
         /** Signals have to be created before they can be configured and stored.
             @param[in] index index of the signal
@@ -254,6 +283,21 @@ namespace gdf
         */
 		void sampleToEvent( const double sample_time_sec, const double sample_physical_value, const uint16 channel, Mode3Event& ev );
 
+        /// Add a batch of samples of a sparse (NEQS) channel
+        /** Each sample becomes a Mode 3 event of type 0x7fff, with the position computed as in sampleToEvent(). The whole
+            batch is validated before anything is written, quantized with the signal header's cached calibration (integer
+            types are rounded to the nearest value; see enableSaturation() for out of range values) and appended to the
+            event buffer with a single write.
+            @param[in] channel 1-based channel index as in event.CHN
+            @param[in] times sample times in seconds
+            @param[in] values physical sample values
+            @param[in] num number of samples
+            @throws exception::event_conversion_error if the channel's data type can not be stored in an event
+            @throws exception::invalid_operation if a time is negative or the event sampling rate is not set
+            @throws boost::numeric::bad_numeric_cast if a value is out of range and saturation is disabled
+        */
+        void addSparseSamples( uint16 channel, const double *times, const double *values, size_t num );
+
         /// Format an existing Mode 1 event (TYP, POS) to represent the given string (TYP) at the given time (POS).
         void makeFreeTextEvent( double noteTimeSec, const std::string str, EventDescriptor & ev_desc, Mode1Event & e );
 
@@ -263,6 +307,13 @@ namespace gdf
 
     private:
 
+        /// sanitize and lock the header; returns warnings
+        /** @throws exception::header_issues if there are errors */
+        std::list< std::string > sanitizeHeader( );
+
+        /// start writing to sink and write the header
+        void openSink( DataSink *sink, bool owns_sink, const int flags, const std::list< std::string > &wmsg );
+
         /// write first full record from record buffer to disk
         void writeRecord( );
 
@@ -274,7 +325,10 @@ namespace gdf
 
         RecordBuffer m_recbuf;
         GDFHeaderAccess m_header;
-        std::fstream m_file;
+        DataSink *m_sink;
+        bool m_owns_sink;
+        SinkStreamBuf *m_sinkbuf;
+        std::ostream m_file;
         std::iostream m_eventbuffer;
         std::fstream m_evbuf_file;
         std::stringstream m_evbuf_memory;
@@ -282,6 +336,8 @@ namespace gdf
         std::string m_filename;
         int64 m_num_datarecords;
         size_t max_full_records;
+        bool m_record_stats_enabled;
+        RecordStatsIndex m_record_stats;
     };
 }
 
@@ -202,35 +202,17 @@ namespace gdf {
     //===================================================================================================
     //===================================================================================================
 
-    void Channel::addSamplePhys( const double value )
+    void Channel::addSamplePhys( const double value, bool saturate )
     {
-        using boost::numeric_cast;
-
-        double rawval = m_signalheader->phys_to_raw( value );
-
-        switch( m_signalheader->get_datatype( ) )
-        {
-        case INT8: m_data->addSample( numeric_cast<int8>(rawval) ); break;
-        case UINT8: m_data->addSample( numeric_cast<uint8>(rawval) ); break;
-        case INT16: m_data->addSample( numeric_cast<int16>(rawval) ); break;
-        case UINT16: m_data->addSample( numeric_cast<uint16>(rawval) ); break;
-        case INT32: m_data->addSample( numeric_cast<int32>(rawval) ); break;
-        case UINT32: m_data->addSample( numeric_cast<uint32>(rawval) ); break;
-        case INT64: m_data->addSample( numeric_cast<int64>(rawval) ); break;
-        case UINT64: m_data->addSample( numeric_cast<uint64>(rawval) ); break;
-        case FLOAT32: m_data->addSample( numeric_cast<float32>(rawval) ); break;
-        case FLOAT64: m_data->addSample( numeric_cast<float64>(rawval) ); break;
-        default: throw exception::invalid_type_id( boost::lexical_cast<std::string>(m_signalheader->get_datatype( )) ); break;
-        };
+        blitSamplesPhys( &value, 1, saturate );
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Channel::blitSamplesPhys( const double *values, size_t num )
+    void Channel::blitSamplesPhys( const double *values, size_t num, bool saturate )
     {
-        for( size_t i=0; i<num; i++ )
-            addSamplePhys( values[i] );
+        m_data->blitSamplesPhys( values, num, m_signalheader->getPhysToRawScale( ), m_signalheader->getPhysToRawOffset( ), saturate );
     }
 
     //===================================================================================================
@@ -331,12 +313,17 @@ namespace gdf {
     //===================================================================================================
     //===================================================================================================
 
-    void Channel::deblitSamplesPhys( double *values, size_t start, size_t num )
+    void Channel::deblitSamplesPhys( double *values, size_t start, size_t num, size_t stride )
     {
-        for( size_t i=0; i<num; i++ )
-        {
-            values[i] = getSamplePhys( start + i );
-        }
+        m_data->deblitSamplesPhys( values, start, num, m_signalheader->getRawToPhysScale( ), m_signalheader->getRawToPhysOffset( ), stride );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Channel::deblitSamplesPhys( float *values, size_t start, size_t num, size_t stride )
+    {
+        m_data->deblitSamplesPhys( values, start, num, m_signalheader->getRawToPhysScale( ), m_signalheader->getRawToPhysOffset( ), stride );
     }
 
     //===================================================================================================
@@ -366,6 +353,14 @@ namespace gdf {
     //===================================================================================================
     //===================================================================================================
 
+    void Channel::frombuffer( const char *in )
+    {
+        m_data->frombuffer( in );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
     std::ostream &operator<<( std::ostream &out, const Channel &c )
     {
         c.m_data->tostream( out );
@@ -0,0 +1,96 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "GDF/ChunkCursor.h"
+#include "GDF/Reader.h"
+#include <boost/numeric/conversion/cast.hpp>
+#include <algorithm>
+#include <string.h>
+
+namespace gdf
+{
+    ChunkCursor::ChunkCursor( Reader *reader, const std::vector<uint16> &signal_indices, size_t chunk_samples, size_t hop )
+        : m_reader( reader ), m_signal_indices( signal_indices ), m_chunk( chunk_samples ), m_hop( hop == 0 ? chunk_samples : hop ),
+          m_total( 0 ), m_position( 0 ), m_valid( 0 ), m_started( false )
+    {
+        if( m_chunk == 0 )
+            throw exception::invalid_operation( "ChunkCursor: chunk_samples must not be 0." );
+
+        if( m_signal_indices.empty( ) )
+        {
+            m_signal_indices.resize( m_reader->getMainHeader_readonly( ).get_num_signals( ) );
+            for( size_t i=0; i<m_signal_indices.size(); i++ )
+                m_signal_indices[i] = boost::numeric_cast<uint16>( i );
+        }
+
+        for( size_t i=0; i<m_signal_indices.size(); i++ )
+        {
+            const SignalHeader &sh = m_reader->getSignalHeader_readonly( m_signal_indices[i] );
+            if( sh.get_samples_per_record( ) != m_reader->getSignalHeader_readonly( m_signal_indices[0] ).get_samples_per_record( ) )
+                throw exception::invalid_operation( "ChunkCursor: all channels must have the same sampling rate." );
+        }
+
+        if( !m_signal_indices.empty( ) )
+            m_total = m_reader->getNumSamples( m_signal_indices[0] );
+
+        m_buffer.resize( m_signal_indices.size( ) * m_chunk );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    bool ChunkCursor::next( )
+    {
+        size_t position = m_started ? m_position + m_hop : 0;
+        if( position >= m_total || m_signal_indices.empty( ) )
+            return false;
+
+        size_t valid = std::min( m_chunk, m_total - position );
+
+        // samples of the previous window that are still needed
+        size_t keep = 0;
+        if( m_started && m_position + m_valid > position )
+            keep = m_position + m_valid - position;
+
+        if( keep > 0 )
+        {
+            for( size_t i=0; i<m_signal_indices.size(); i++ )
+                memmove( &m_buffer[i*m_chunk], &m_buffer[i*m_chunk + m_hop], keep * sizeof(double) );
+        }
+
+        std::vector<double*> out( m_signal_indices.size( ) );
+        for( size_t i=0; i<m_signal_indices.size(); i++ )
+            out[i] = &m_buffer[i*m_chunk + keep];
+        m_reader->readWindow( m_signal_indices, position + keep, position + valid, &out[0] );
+
+        m_position = position;
+        m_valid = valid;
+        m_started = true;
+        return true;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ChunkCursor::reset( )
+    {
+        m_position = 0;
+        m_valid = 0;
+        m_started = false;
+    }
+}
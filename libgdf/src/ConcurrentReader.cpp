@@ -0,0 +1,333 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "GDF/ConcurrentReader.h"
+#include "GDF/Conversion.h"
+#include "GDF/DataSource.h"
+#include "GDF/Reader.h"
+#include <boost/lexical_cast.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+namespace gdf
+{
+    ConcurrentReader::ConcurrentReader( )
+    {
+        m_source = NULL;
+        m_events = NULL;
+        m_cache_enabled = true;
+        m_cache_max_records = 0;
+        m_num_records = 0;
+        m_record_length = 0;
+        m_record_offset = 0;
+        m_event_offset = 0;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    ConcurrentReader::~ConcurrentReader( )
+    {
+        close( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::open( const std::string filename )
+    {
+        assert( m_source == NULL );
+
+        m_source = new FileSource( filename );
+        try
+        {
+            SourceStreamBuf buf( *m_source );
+            std::istream in( &buf );
+            in >> m_header;
+        }
+        catch( ... )
+        {
+            delete m_source;
+            m_source = NULL;
+            throw;
+        }
+        Reader::initSampleRates( m_header );
+        m_filename = filename;
+
+        // determine record layout
+        m_record_length = 0;
+        m_channel_offset.resize( m_header.getMainHeader_readonly().get_num_signals() );
+        for( size_t i=0; i<m_header.getMainHeader_readonly().get_num_signals(); i++ )
+        {
+            m_channel_offset[i] = m_record_length;
+            size_t samplesize = datatype_size( m_header.getSignalHeader_readonly( i ).get_datatype( ) );
+            m_record_length += samplesize * m_header.getSignalHeader_readonly( i ).get_samples_per_record( );
+        }
+
+        m_num_records = boost::numeric_cast<size_t>( m_header.getMainHeader_readonly().get_num_datarecords() );
+        m_record_offset = m_header.getMainHeader_readonly().get_header_length( ) * 256;
+        m_event_offset = m_record_offset + m_num_records * m_record_length;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::close( )
+    {
+        resetCache( );
+        if( m_events ) delete m_events;
+        m_events = NULL;
+        if( m_source ) delete m_source;
+        m_source = NULL;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::enableCache( bool b )
+    {
+        m_cache_enabled = b;
+        resetCache( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::setMaxCacheRecords( size_t num )
+    {
+        m_cache_max_records = num;
+        resetCache( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t ConcurrentReader::getNumCachedRecords( )
+    {
+        size_t num = 0;
+        for( size_t i=0; i<NUM_SHARDS; i++ )
+        {
+            boost::mutex::scoped_lock lock( m_shards[i].mutex );
+            num += m_shards[i].records.size( );
+        }
+        return num;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::resetCache( )
+    {
+        for( size_t i=0; i<NUM_SHARDS; i++ )
+        {
+            boost::mutex::scoped_lock lock( m_shards[i].mutex );
+            m_shards[i].records.clear( );
+            m_shards[i].lru.clear( );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::getSignals( std::vector< std::vector<double> > &buffer, double start_time, double end_time, std::vector<uint16> signal_indices )
+    {
+        if( m_source == NULL )
+            throw exception::file_not_open( "when attempting to read signals" );
+
+        std::vector<size_t> start, end;
+        Reader::computeSignalRanges( m_header, start_time, end_time, signal_indices, start, end );
+
+        buffer.resize( signal_indices.size() );
+        std::vector<double*> out( signal_indices.size() );
+        for( size_t i=0; i<signal_indices.size(); i++ )
+        {
+            buffer[i].resize( end[i] - start[i] );
+            out[i] = buffer[i].empty( ) ? NULL : &buffer[i][0];
+        }
+        readSignals( signal_indices, start, end, out );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::getSignal( uint16 channel_idx, double *buffer, size_t start, size_t end )
+    {
+        const SignalHeader *sh = &m_header.getSignalHeader_readonly( channel_idx );
+
+        if( m_source == NULL )
+            throw exception::file_not_open( "when attempting to read signals" );
+
+        size_t total = sh->get_samples_per_record( ) * m_num_records;
+        if( end <= start )
+            end = total;
+        end = std::min( end, total );
+        if( start >= end )
+            return;
+
+        readSignals( std::vector<uint16>( 1, channel_idx ), std::vector<size_t>( 1, start ), std::vector<size_t>( 1, end ), std::vector<double*>( 1, buffer ) );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::readSignals( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end,
+                                        const std::vector<double*> &out )
+    {
+        size_t record, end_record;
+        Reader::computeRecordRange( m_header, signal_indices, start, end, record, end_record );
+
+        // without cache, records are read in blocks into a buffer owned by this call
+        std::vector<char> block;
+        size_t block_first = 0, block_num = 0;
+        size_t block_records = Reader::getBlockRecords( m_record_length );
+
+        for( ; record < end_record; record++ )
+        {
+            RawRecordPtr cached;
+            const char *raw;
+            if( m_cache_enabled )
+            {
+                cached = getRawRecord( record );
+                raw = &(*cached)[0];
+            }
+            else
+            {
+                if( record >= block_first + block_num )
+                {
+                    block_first = record;
+                    block_num = std::min( end_record - record, block_records );
+                    block.resize( std::max( block_num * m_record_length, size_t(1) ) );
+                    readRecords( block_first, block_num, &block[0] );
+                }
+                raw = &block[0] + ( record - block_first ) * m_record_length;
+            }
+            for( size_t i=0; i<signal_indices.size(); i++ )
+            {
+                size_t spr = m_header.getSignalHeader_readonly( signal_indices[i] ).get_samples_per_record( );
+                size_t lo = std::max( record * spr, start[i] );
+                size_t hi = std::min( ( record + 1 ) * spr, end[i] );
+                if( lo < hi )
+                    deblitRawSamplesPhys( signal_indices[i], raw, out[i] + ( lo - start[i] ), lo - record * spr, hi - lo );
+            }
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    double ConcurrentReader::getSample( uint16 channel_idx, size_t sample_idx )
+    {
+        if( m_source == NULL )
+            throw exception::file_not_open( "when attempting to read signals" );
+        if( sample_idx >= m_header.getSignalHeader_readonly( channel_idx ).get_samples_per_record( ) * m_num_records )
+            throw exception::index_out_of_range( "sample " + boost::lexical_cast<std::string>( sample_idx ) );
+
+        double value;
+        getSignal( channel_idx, &value, sample_idx, sample_idx+1 );
+        return value;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    EventHeader *ConcurrentReader::getEventHeader( )
+    {
+        boost::mutex::scoped_lock lock( m_event_mutex );
+        if( m_events == NULL )
+        {
+            if( m_source == NULL )
+                throw exception::file_not_open( "when attempting to read events" );
+            SourceStreamBuf buf( *m_source, m_event_offset );
+            std::istream in( &buf );
+            m_events = new EventHeader( );
+            m_events->fromStream( in );
+        }
+        return m_events;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    ConcurrentReader::RawRecordPtr ConcurrentReader::getRawRecord( size_t index )
+    {
+        assert( index < m_num_records );
+        size_t shard_idx = index % NUM_SHARDS;
+        CacheShard &shard = m_shards[shard_idx];
+
+        {
+            boost::mutex::scoped_lock lock( shard.mutex );
+            std::map< size_t, std::pair< RawRecordPtr, std::list<size_t>::iterator > >::iterator it = shard.records.find( index );
+            if( it != shard.records.end( ) )
+            {
+                shard.lru.splice( shard.lru.end( ), shard.lru, it->second.second );
+                return it->second.first;
+            }
+        }
+
+        // read without holding the lock, so that other threads can use the shard meanwhile
+        boost::shared_ptr< std::vector<char> > rec( new std::vector<char>( std::max( m_record_length, size_t(1) ) ) );
+        readRecords( index, 1, &(*rec)[0] );
+
+        boost::mutex::scoped_lock lock( shard.mutex );
+        std::map< size_t, std::pair< RawRecordPtr, std::list<size_t>::iterator > >::iterator it = shard.records.find( index );
+        if( it != shard.records.end( ) )
+            return it->second.first;    // another thread was faster
+
+        if( m_cache_max_records > 0 )
+        {
+            // the limit is split over the shards; the first shards get the remainder
+            size_t capacity = m_cache_max_records / NUM_SHARDS + ( shard_idx < m_cache_max_records % NUM_SHARDS ? 1 : 0 );
+            if( capacity == 0 )
+                return rec;
+            if( shard.records.size( ) >= capacity )
+            {
+                shard.records.erase( shard.lru.front( ) );
+                shard.lru.pop_front( );
+            }
+        }
+        shard.lru.push_back( index );
+        std::list<size_t>::iterator pos = shard.lru.end( );
+        pos--;
+        shard.records[index] = std::make_pair( RawRecordPtr( rec ), pos );
+        return rec;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::readRecords( size_t start, size_t num, char *buffer ) const
+    {
+        if( num * m_record_length == 0 )
+            return;
+        m_source->readAt( m_record_offset + static_cast<uint64>( m_record_length ) * start, buffer, num * m_record_length );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void ConcurrentReader::deblitRawSamplesPhys( uint16 channel_idx, const char *record, double *buffer, size_t start, size_t num ) const
+    {
+        const SignalHeader *sh = &m_header.getSignalHeader_readonly( channel_idx );
+        uint32 datatype = sh->get_datatype( );
+        const char *in = record + m_channel_offset[channel_idx] + start * datatype_size( datatype );
+
+        convertRawToPhys( datatype, in, buffer, num, sh->getRawToPhysScale( ), sh->getRawToPhysOffset( ) );
+    }
+}
@@ -0,0 +1,58 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "GDF/Conversion.h"
+#include <boost/lexical_cast.hpp>
+
+namespace gdf
+{
+    template<typename U>
+    static void convertRawToPhysDispatch( uint32 datatype, const char *in, U *phys, size_t num, double scale, double offset, size_t stride )
+    {
+        switch( datatype )
+        {
+        case INT8: convertRawToPhys<int8>( in, phys, num, scale, offset, stride ); break;
+        case UINT8: convertRawToPhys<uint8>( in, phys, num, scale, offset, stride ); break;
+        case INT16: convertRawToPhys<int16>( in, phys, num, scale, offset, stride ); break;
+        case UINT16: convertRawToPhys<uint16>( in, phys, num, scale, offset, stride ); break;
+        case INT32: convertRawToPhys<int32>( in, phys, num, scale, offset, stride ); break;
+        case UINT32: convertRawToPhys<uint32>( in, phys, num, scale, offset, stride ); break;
+        case INT64: convertRawToPhys<int64>( in, phys, num, scale, offset, stride ); break;
+        case UINT64: convertRawToPhys<uint64>( in, phys, num, scale, offset, stride ); break;
+        case FLOAT32: convertRawToPhys<float32>( in, phys, num, scale, offset, stride ); break;
+        case FLOAT64: convertRawToPhys<float64>( in, phys, num, scale, offset, stride ); break;
+        default: throw exception::invalid_type_id( boost::lexical_cast<std::string>( datatype ) ); break;
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void convertRawToPhys( uint32 datatype, const char *in, float64 *phys, size_t num, double scale, double offset, size_t stride )
+    {
+        convertRawToPhysDispatch( datatype, in, phys, num, scale, offset, stride );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void convertRawToPhys( uint32 datatype, const char *in, float32 *phys, size_t num, double scale, double offset, size_t stride )
+    {
+        convertRawToPhysDispatch( datatype, in, phys, num, scale, offset, stride );
+    }
+}
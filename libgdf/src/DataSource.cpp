@@ -0,0 +1,794 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "GDF/DataSource.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef GDF_WITH_IO_URING
+#include <linux/io_uring.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <string.h>
+#endif
+
+namespace gdf
+{
+    /// Size of the buffers of SourceStreamBuf and SinkStreamBuf
+    static const size_t STREAM_BUFFER_SIZE = 64*1024;
+
+    /// Number of reads FileSource::readBatch() keeps in flight
+    static const unsigned IO_URING_DEPTH = 64;
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t DataSource::readSome( uint64 offset, char *buffer, size_t bytes ) const
+    {
+        uint64 total = size( );
+        if( offset >= total )
+            return 0;
+        bytes = static_cast<size_t>( std::min( uint64( bytes ), total - offset ) );
+        readAt( offset, buffer, bytes );
+        return bytes;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void DataSource::readBatch( const std::vector<ReadRequest> &requests ) const
+    {
+        for( size_t i=0; i<requests.size(); i++ )
+            readAt( requests[i].offset, requests[i].buffer, requests[i].bytes );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+#ifdef GDF_WITH_IO_URING
+
+    /// Minimal io_uring for positional reads, driven by raw system calls so that liburing is not needed
+    class IoUring
+    {
+    public:
+        /// Set up a ring with depth entries; returns NULL if the kernel does not provide io_uring
+        static IoUring *create( unsigned depth );
+
+        /// Destructor; unmaps and closes the ring
+        ~IoUring( );
+
+        /// Submit requests on file descriptor fd and wait for all of them
+        /** done[i] receives the number of bytes read for request i. Reads that failed or were short are
+            not retried; the caller completes them.
+            @return false if the ring failed. All submitted reads have completed by then, but the ring
+                    must not be used again. */
+        bool read( int fd, const std::vector<ReadRequest> &requests, std::vector<size_t> &done );
+
+    private:
+        IoUring( int fd );
+        IoUring( const IoUring & );
+        IoUring &operator=( const IoUring & );
+
+        static void *mapRing( int fd, size_t size, off_t offset );
+
+        /// Move completions to done; returns the number of completions
+        size_t reap( std::vector<size_t> &done );
+
+        /// Wait until inflight submitted reads have completed
+        void drain( size_t inflight, std::vector<size_t> &done );
+
+        int m_fd;
+        unsigned m_entries;
+        void *m_sq_ring;
+        size_t m_sq_ring_size;
+        void *m_cq_ring;
+        size_t m_cq_ring_size;
+        io_uring_sqe *m_sqes;
+        size_t m_sqes_size;
+
+        unsigned *m_sq_tail, *m_sq_mask, *m_sq_array;
+        unsigned *m_cq_head, *m_cq_tail, *m_cq_mask;
+        io_uring_cqe *m_cqes;
+    };
+
+    //===================================================================================================
+    //===================================================================================================
+
+    IoUring::IoUring( int fd )
+        : m_fd( fd ), m_entries( 0 ), m_sq_ring( NULL ), m_sq_ring_size( 0 ), m_cq_ring( NULL ), m_cq_ring_size( 0 ),
+          m_sqes( NULL ), m_sqes_size( 0 )
+    {
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    IoUring::~IoUring( )
+    {
+        if( m_sqes )
+            munmap( m_sqes, m_sqes_size );
+        if( m_cq_ring && m_cq_ring != m_sq_ring )
+            munmap( m_cq_ring, m_cq_ring_size );
+        if( m_sq_ring )
+            munmap( m_sq_ring, m_sq_ring_size );
+        ::close( m_fd );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void *IoUring::mapRing( int fd, size_t size, off_t offset )
+    {
+        void *p = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset );
+        return p == MAP_FAILED ? NULL : p;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    IoUring *IoUring::create( unsigned depth )
+    {
+        io_uring_params params;
+        memset( &params, 0, sizeof(params) );
+        int fd = static_cast<int>( syscall( __NR_io_uring_setup, depth, &params ) );
+        if( fd < 0 )
+            return NULL;
+
+        IoUring *ring = new IoUring( fd );
+        ring->m_entries = params.sq_entries;
+        ring->m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = ( params.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+        if( single )
+            ring->m_sq_ring_size = ring->m_cq_ring_size = std::max( ring->m_sq_ring_size, ring->m_cq_ring_size );
+
+        ring->m_sq_ring = mapRing( fd, ring->m_sq_ring_size, IORING_OFF_SQ_RING );
+        if( ring->m_sq_ring )
+            ring->m_cq_ring = single ? ring->m_sq_ring : mapRing( fd, ring->m_cq_ring_size, IORING_OFF_CQ_RING );
+        ring->m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        if( ring->m_cq_ring )
+            ring->m_sqes = static_cast<io_uring_sqe*>( mapRing( fd, ring->m_sqes_size, IORING_OFF_SQES ) );
+        if( !ring->m_sqes )
+        {
+            delete ring;
+            return NULL;
+        }
+
+        char *sq = static_cast<char*>( ring->m_sq_ring );
+        ring->m_sq_tail = reinterpret_cast<unsigned*>( sq + params.sq_off.tail );
+        ring->m_sq_mask = reinterpret_cast<unsigned*>( sq + params.sq_off.ring_mask );
+        ring->m_sq_array = reinterpret_cast<unsigned*>( sq + params.sq_off.array );
+        char *cq = static_cast<char*>( ring->m_cq_ring );
+        ring->m_cq_head = reinterpret_cast<unsigned*>( cq + params.cq_off.head );
+        ring->m_cq_tail = reinterpret_cast<unsigned*>( cq + params.cq_off.tail );
+        ring->m_cq_mask = reinterpret_cast<unsigned*>( cq + params.cq_off.ring_mask );
+        ring->m_cqes = reinterpret_cast<io_uring_cqe*>( cq + params.cq_off.cqes );
+        return ring;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    bool IoUring::read( int fd, const std::vector<ReadRequest> &requests, std::vector<size_t> &done )
+    {
+        done.assign( requests.size( ), 0 );
+        size_t next = 0, inflight = 0;
+        unsigned pending = 0;   // queued but not yet consumed by the kernel
+        while( next < requests.size( ) || pending > 0 || inflight > 0 )
+        {
+            // fill the submission queue; we are its only producer
+            unsigned tail = *m_sq_tail;
+            for( ; next < requests.size( ) && inflight + pending < m_entries; next++, pending++ )
+            {
+                unsigned slot = tail & *m_sq_mask;
+                io_uring_sqe &sqe = m_sqes[slot];
+                memset( &sqe, 0, sizeof(sqe) );
+                sqe.opcode = IORING_OP_READ;
+                sqe.fd = fd;
+                sqe.off = requests[next].offset;
+                sqe.addr = reinterpret_cast<size_t>( requests[next].buffer );
+                sqe.len = static_cast<uint32>( std::min( requests[next].bytes, size_t(1) << 30 ) );
+                sqe.user_data = next;
+                m_sq_array[slot] = slot;
+                tail++;
+            }
+            __atomic_store_n( m_sq_tail, tail, __ATOMIC_RELEASE );
+
+            long ret = syscall( __NR_io_uring_enter, m_fd, pending, inflight > 0 ? 1 : 0, IORING_ENTER_GETEVENTS, NULL, 0 );
+            if( ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY )
+            {
+                // queued entries are never submitted; the ring is discarded by the caller
+                drain( inflight, done );
+                return false;
+            }
+            if( ret > 0 )
+            {
+                // the kernel may consume fewer entries than queued; the rest is submitted next time
+                pending -= static_cast<unsigned>( ret );
+                inflight += static_cast<size_t>( ret );
+            }
+            inflight -= reap( done );
+        }
+        return true;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t IoUring::reap( std::vector<size_t> &done )
+    {
+        unsigned head = *m_cq_head;
+        unsigned cq_tail = __atomic_load_n( m_cq_tail, __ATOMIC_ACQUIRE );
+        size_t num = 0;
+        for( ; head != cq_tail; head++, num++ )
+        {
+            const io_uring_cqe &cqe = m_cqes[head & *m_cq_mask];
+            if( cqe.res > 0 && cqe.user_data < done.size( ) )
+                done[cqe.user_data] = cqe.res;
+        }
+        __atomic_store_n( m_cq_head, head, __ATOMIC_RELEASE );
+        return num;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void IoUring::drain( size_t inflight, std::vector<size_t> &done )
+    {
+        while( inflight > 0 )
+        {
+            // if waiting in the kernel fails too, poll the completion queue
+            if( syscall( __NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0 ) < 0 && errno != EINTR )
+                sched_yield( );
+            inflight -= reap( done );
+        }
+    }
+
+#endif
+
+    //===================================================================================================
+    //===================================================================================================
+
+#ifndef _WIN32
+
+    FileSource::FileSource( const std::string filename ) : m_ring( NULL ), m_ring_tried( false )
+    {
+        m_fd = ::open( filename.c_str(), O_RDONLY );
+        if( m_fd < 0 )
+            throw exception::file_exists_not( filename );
+        struct stat st;
+        if( fstat( m_fd, &st ) != 0 )
+        {
+            ::close( m_fd );
+            throw exception::file_exists_not( filename );
+        }
+        m_size = st.st_size;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    FileSource::~FileSource( )
+    {
+#ifdef GDF_WITH_IO_URING
+        delete m_ring;
+#endif
+        ::close( m_fd );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void FileSource::readAt( uint64 offset, char *buffer, size_t bytes ) const
+    {
+        while( bytes > 0 )
+        {
+            ssize_t n = pread( m_fd, buffer, bytes, offset );
+            if( n < 0 && errno == EINTR )
+                continue;
+            if( n <= 0 )
+                throw exception::serialization_error( "unexpected end of file while reading data records" );
+            buffer += n;
+            bytes -= n;
+            offset += n;
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void FileSource::readBatch( const std::vector<ReadRequest> &requests ) const
+    {
+#ifdef GDF_WITH_IO_URING
+        if( requests.size( ) > 1 )
+        {
+            boost::mutex::scoped_lock lock( m_ring_mutex );
+            if( !m_ring_tried )
+            {
+                m_ring_tried = true;
+                m_ring = IoUring::create( IO_URING_DEPTH );
+            }
+            if( m_ring )
+            {
+                std::vector<size_t> done;
+                if( !m_ring->read( m_fd, requests, done ) )
+                {
+                    // use pread from now on
+                    delete m_ring;
+                    m_ring = NULL;
+                }
+                lock.unlock( );
+
+                // complete failed and short reads synchronously
+                for( size_t i=0; i<requests.size(); i++ )
+                    if( done[i] < requests[i].bytes )
+                        readAt( requests[i].offset + done[i], requests[i].buffer + done[i], requests[i].bytes - done[i] );
+                return;
+            }
+        }
+#endif
+        DataSource::readBatch( requests );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    FileSink::FileSink( const std::string filename ) : m_size( 0 )
+    {
+        m_fd = ::open( filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+        if( m_fd < 0 )
+            throw exception::serialization_error( "can not create " + filename );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    FileSink::~FileSink( )
+    {
+        ::close( m_fd );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void FileSink::writeAt( uint64 offset, const char *buffer, size_t bytes )
+    {
+        uint64 end = offset + bytes;
+        while( bytes > 0 )
+        {
+            ssize_t n = pwrite( m_fd, buffer, bytes, offset );
+            if( n < 0 && errno == EINTR )
+                continue;
+            if( n <= 0 )
+                throw exception::serialization_error( "error while writing to file" );
+            buffer += n;
+            bytes -= n;
+            offset += n;
+        }
+        m_size = std::max( m_size, end );
+    }
+
+#else
+
+    FileSource::FileSource( const std::string filename ) : m_ring( NULL ), m_ring_tried( false )
+    {
+        m_file.open( filename.c_str(), std::ios_base::in | std::ios_base::binary );
+        if( m_file.fail() )
+            throw exception::file_exists_not( filename );
+        m_file.seekg( 0, std::ios_base::end );
+        m_size = m_file.tellg( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    FileSource::~FileSource( )
+    {
+        m_file.close( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void FileSource::readAt( uint64 offset, char *buffer, size_t bytes ) const
+    {
+        boost::mutex::scoped_lock lock( m_mutex );
+        m_file.seekg( offset );
+        m_file.read( buffer, bytes );
+        if( m_file.fail( ) )
+        {
+            m_file.clear( );
+            throw exception::serialization_error( "unexpected end of file while reading data records" );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void FileSource::readBatch( const std::vector<ReadRequest> &requests ) const
+    {
+        DataSource::readBatch( requests );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    FileSink::FileSink( const std::string filename ) : m_size( 0 )
+    {
+        m_file.open( filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+        if( m_file.fail() )
+            throw exception::serialization_error( "can not create " + filename );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    FileSink::~FileSink( )
+    {
+        m_file.close( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void FileSink::writeAt( uint64 offset, const char *buffer, size_t bytes )
+    {
+        m_file.seekp( offset );
+        m_file.write( buffer, bytes );
+        if( m_file.fail( ) )
+        {
+            m_file.clear( );
+            throw exception::serialization_error( "error while writing to file" );
+        }
+        m_size = std::max( m_size, offset + bytes );
+    }
+
+#endif
+
+    //===================================================================================================
+    //===================================================================================================
+
+    MappedSource::MappedSource( const std::string filename ) : m_mapping( NULL ), m_region( NULL ), m_data( NULL )
+    {
+        using namespace boost::interprocess;
+
+        m_size = FileSource( filename ).size( );
+        if( m_size == 0 )
+            return;     // empty files can not be mapped
+        try
+        {
+            m_mapping = new file_mapping( filename.c_str(), read_only );
+            m_region = new mapped_region( *m_mapping, read_only );
+        }
+        catch( interprocess_exception & )
+        {
+            delete m_mapping;
+            m_mapping = NULL;
+            throw exception::file_exists_not( filename );
+        }
+        m_data = static_cast<const char*>( m_region->get_address( ) );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    MappedSource::~MappedSource( )
+    {
+        delete m_region;
+        delete m_mapping;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void MappedSource::readAt( uint64 offset, char *buffer, size_t bytes ) const
+    {
+        if( offset > m_size || bytes > m_size - offset )
+            throw exception::serialization_error( "unexpected end of file while reading data records" );
+        if( bytes > 0 )
+            memcpy( buffer, m_data + offset, bytes );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    MemorySource::MemorySource( const char *data, size_t size ) : m_data( data ), m_size( size )
+    {
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    MemorySource::MemorySource( std::vector<char> &buffer )
+    {
+        m_buffer.swap( buffer );
+        m_data = m_buffer.empty( ) ? NULL : &m_buffer[0];
+        m_size = m_buffer.size( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void MemorySource::readAt( uint64 offset, char *buffer, size_t bytes ) const
+    {
+        if( offset > m_size || bytes > m_size - offset )
+            throw exception::serialization_error( "unexpected end of buffer while reading data records" );
+        if( bytes > 0 )
+            memcpy( buffer, m_data + offset, bytes );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    PipeSource::PipeSource( std::istream &in ) : m_in( in ), m_eof( false )
+    {
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void PipeSource::fill( uint64 end ) const
+    {
+        while( !m_eof && m_buffer.size( ) < end )
+        {
+            size_t have = m_buffer.size( );
+            size_t want = static_cast<size_t>( std::min( std::max( end - have, uint64( STREAM_BUFFER_SIZE ) ), uint64( 64*STREAM_BUFFER_SIZE ) ) );
+            m_buffer.resize( have + want );
+            m_in.read( &m_buffer[have], want );
+            m_buffer.resize( have + static_cast<size_t>( m_in.gcount( ) ) );
+            if( !m_in )
+                m_eof = true;
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void PipeSource::readAt( uint64 offset, char *buffer, size_t bytes ) const
+    {
+        if( readSome( offset, buffer, bytes ) != bytes )
+            throw exception::serialization_error( "unexpected end of stream while reading data records" );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t PipeSource::readSome( uint64 offset, char *buffer, size_t bytes ) const
+    {
+        boost::mutex::scoped_lock lock( m_mutex );
+        fill( offset + bytes );
+        if( offset >= m_buffer.size( ) )
+            return 0;
+        bytes = static_cast<size_t>( std::min( uint64( bytes ), m_buffer.size( ) - offset ) );
+        if( bytes > 0 )
+            memcpy( buffer, &m_buffer[static_cast<size_t>( offset )], bytes );
+        return bytes;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    uint64 PipeSource::size( ) const
+    {
+        boost::mutex::scoped_lock lock( m_mutex );
+        fill( static_cast<uint64>( -1 ) );
+        return m_buffer.size( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void MemorySink::writeAt( uint64 offset, const char *buffer, size_t bytes )
+    {
+        size_t end = boost::numeric_cast<size_t>( offset + bytes );
+        if( m_buffer.size( ) < end )
+            m_buffer.resize( end );
+        if( bytes > 0 )
+            memcpy( &m_buffer[static_cast<size_t>( offset )], buffer, bytes );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void PipeSink::writeAt( uint64 offset, const char *buffer, size_t bytes )
+    {
+        if( offset != m_size )
+            throw exception::invalid_operation( "a pipe can only be appended to" );
+        m_out.write( buffer, bytes );
+        if( m_out.fail( ) )
+            throw exception::serialization_error( "error while writing to stream" );
+        m_size += bytes;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SourceStreamBuf::SourceStreamBuf( const DataSource &source, uint64 offset )
+        : m_source( source ), m_buffer( STREAM_BUFFER_SIZE ), m_base( offset )
+    {
+        setg( &m_buffer[0], &m_buffer[0], &m_buffer[0] );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SourceStreamBuf::int_type SourceStreamBuf::underflow( )
+    {
+        if( gptr( ) < egptr( ) )
+            return traits_type::to_int_type( *gptr( ) );
+        m_base += egptr( ) - eback( );
+        size_t n = m_source.readSome( m_base, &m_buffer[0], m_buffer.size( ) );
+        setg( &m_buffer[0], &m_buffer[0], &m_buffer[0] + n );
+        if( n == 0 )
+            return traits_type::eof( );
+        return traits_type::to_int_type( *gptr( ) );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SourceStreamBuf::pos_type SourceStreamBuf::seekoff( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which )
+    {
+        off_type base;
+        switch( dir )
+        {
+        case std::ios_base::beg: base = 0; break;
+        case std::ios_base::cur: base = static_cast<off_type>( m_base + ( gptr( ) - eback( ) ) ); break;
+        default: base = static_cast<off_type>( m_source.size( ) ); break;
+        }
+        return seekpos( pos_type( base + off ), which );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SourceStreamBuf::pos_type SourceStreamBuf::seekpos( pos_type pos, std::ios_base::openmode which )
+    {
+        if( !( which & std::ios_base::in ) || off_type( pos ) < 0 )
+            return pos_type( off_type( -1 ) );
+        uint64 target = static_cast<uint64>( off_type( pos ) );
+        if( target >= m_base && target < m_base + ( egptr( ) - eback( ) ) )
+            setg( eback( ), eback( ) + static_cast<size_t>( target - m_base ), egptr( ) );
+        else
+        {
+            m_base = target;
+            setg( &m_buffer[0], &m_buffer[0], &m_buffer[0] );
+        }
+        return pos;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SinkStreamBuf::SinkStreamBuf( DataSink &sink, uint64 offset )
+        : m_sink( sink ), m_buffer( STREAM_BUFFER_SIZE ), m_base( offset )
+    {
+        setp( &m_buffer[0], &m_buffer[0] + m_buffer.size( ) );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SinkStreamBuf::~SinkStreamBuf( )
+    {
+        try
+        {
+            writeBuffer( );
+        }
+        catch( ... )
+        {
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void SinkStreamBuf::writeBuffer( )
+    {
+        size_t n = pptr( ) - pbase( );
+        setp( &m_buffer[0], &m_buffer[0] + m_buffer.size( ) );
+        if( n > 0 )
+        {
+            m_sink.writeAt( m_base, &m_buffer[0], n );
+            m_base += n;
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SinkStreamBuf::int_type SinkStreamBuf::overflow( int_type c )
+    {
+        writeBuffer( );
+        if( !traits_type::eq_int_type( c, traits_type::eof( ) ) )
+        {
+            *pptr( ) = traits_type::to_char_type( c );
+            pbump( 1 );
+        }
+        return traits_type::not_eof( c );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    std::streamsize SinkStreamBuf::xsputn( const char *s, std::streamsize n )
+    {
+        if( n < epptr( ) - pptr( ) )
+        {
+            memcpy( pptr( ), s, static_cast<size_t>( n ) );
+            pbump( static_cast<int>( n ) );
+            return n;
+        }
+        // large writes bypass the buffer
+        writeBuffer( );
+        m_sink.writeAt( m_base, s, static_cast<size_t>( n ) );
+        m_base += n;
+        return n;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    int SinkStreamBuf::sync( )
+    {
+        writeBuffer( );
+        m_sink.flush( );
+        return 0;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SinkStreamBuf::pos_type SinkStreamBuf::seekoff( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which )
+    {
+        writeBuffer( );
+        off_type base;
+        switch( dir )
+        {
+        case std::ios_base::beg: base = 0; break;
+        case std::ios_base::cur: base = static_cast<off_type>( m_base ); break;
+        default: base = static_cast<off_type>( m_sink.size( ) ); break;
+        }
+        return seekpos( pos_type( base + off ), which );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    SinkStreamBuf::pos_type SinkStreamBuf::seekpos( pos_type pos, std::ios_base::openmode which )
+    {
+        if( !( which & std::ios_base::out ) || off_type( pos ) < 0 )
+            return pos_type( off_type( -1 ) );
+        writeBuffer( );
+        uint64 target = static_cast<uint64>( off_type( pos ) );
+        if( target != m_base && !m_sink.isSeekable( ) )
+            return pos_type( off_type( -1 ) );
+        m_base = target;
+        return pos;
+    }
+}
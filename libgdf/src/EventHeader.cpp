@@ -27,7 +27,17 @@
 
 namespace gdf
 {
-    EventHeader::EventHeader( ) : m_mode1(), m_mode3()
+    /// Orders event indices by event position
+    struct EventPositionLess
+    {
+        EventPositionLess( const std::vector<Mode1Event> *m1, const std::vector<Mode3Event> *m3 ) : mode1( m1 ), mode3( m3 ) { }
+        uint32 pos( uint32 i ) const { return mode1 ? (*mode1)[i].position : (*mode3)[i].position; }
+        bool operator()( uint32 a, uint32 b ) const { return pos( a ) < pos( b ); }
+        const std::vector<Mode1Event> *mode1;
+        const std::vector<Mode3Event> *mode3;
+    };
+
+    EventHeader::EventHeader( ) : m_mode1(), m_mode3(), m_index_valid( false )
     {
         m_mode = 1;
         m_efs = -1;
@@ -37,6 +47,40 @@ namespace gdf
     {
     }
 
+    /// Read a column of n little endian values with a single read
+    template<typename T>
+    static void readColumn( std::istream &stream, std::vector<T> &column, size_t n )
+    {
+        column.resize( n );
+        if( n == 0 )
+            return;
+#if BOOST_ENDIAN_LITTLE_BYTE
+        stream.read( reinterpret_cast<char*>( &column[0] ), n * sizeof(T) );
+#else
+        std::vector<char> buffer( n * sizeof(T) );
+        stream.read( &buffer[0], buffer.size( ) );
+        for( size_t i=0; i<n; i++ )
+            readLittleEndian( &buffer[i*sizeof(T)], column[i] );
+#endif
+    }
+
+    /// Write a column of values in little endian with a single write
+    template<typename T>
+    static void writeColumn( std::ostream &stream, const std::vector<T> &column )
+    {
+        if( column.empty( ) )
+            return;
+#if BOOST_ENDIAN_LITTLE_BYTE
+        stream.write( reinterpret_cast<const char*>( &column[0] ), column.size( ) * sizeof(T) );
+#else
+        std::ostringstream buffer;
+        for( size_t i=0; i<column.size(); i++ )
+            writeLittleEndian( buffer, column[i] );
+        stream << buffer.str( );
+#endif
+    }
+
+    //-------------------------------------------------------------------------
     void EventHeader::toStream( std::ostream &stream )
     {
         stream.write( reinterpret_cast<const char*>(&m_mode), 1 );
@@ -51,52 +95,22 @@ namespace gdf
 
         writeLittleEndian( stream, getSamplingRate( ) );
 
-        if( getMode() == 1 )
-        {
-            Mode1Event e;
-            // write event positions
-            for( size_t i=0; i<getNumEvents(); i++)
-            {
-                getEvent( i, e );
-                writeLittleEndian( stream, e.position );
-            }
-            // write event types
-            for( size_t i=0; i<getNumEvents(); i++)
-            {
-                getEvent( i, e );
-                writeLittleEndian( stream, e.type );
-            }
-        }
-        else if( getMode() == 3 )
+        if( getMode() != 1 && getMode() != 3 )
+            return;
+
+        // each column is written with a single write
+        EventColumns columns;
+        getColumns( columns );
+        writeColumn( stream, columns.position );
+        writeColumn( stream, columns.type );
+        if( getMode() == 3 )
         {
-            Mode3Event e;
-            // write event positions
-            for( size_t i=0; i<getNumEvents(); i++)
-            {
-                getEvent( i, e );
-                writeLittleEndian( stream, e.position );
-            }
-            // write event types
-            for( size_t i=0; i<getNumEvents(); i++)
-            {
-                getEvent( i, e );
-                writeLittleEndian( stream, e.type );
-            }
-            // write event channels
-            for( size_t i=0; i<getNumEvents(); i++)
-            {
-                getEvent( i, e );
-                writeLittleEndian( stream, e.channel );
-            }
-            // write event durations
-            for( size_t i=0; i<getNumEvents(); i++)
-            {
-                getEvent( i, e );
-                writeLittleEndian( stream, e.duration );
-            }
+            writeColumn( stream, columns.channel );
+            writeColumn( stream, columns.duration );
         }
     }
 
+    //-------------------------------------------------------------------------
     void EventHeader::fromStream( std::istream &stream )
     {
         clear( );
@@ -114,47 +128,92 @@ namespace gdf
         readLittleEndian( stream, efs );
         setSamplingRate( efs );
 
-        std::vector<uint32> positions;
-        std::vector<uint16> types;
-        positions.resize( nev );
-        types.resize( nev );
-        for( size_t i=0; i<nev; i++ )
-            readLittleEndian( stream, positions[i] );
-        for( size_t i=0; i<nev; i++ )
-            readLittleEndian( stream, types[i] );
+        if( getMode() != 1 && getMode() != 3 )
+            throw exception::invalid_eventmode( boost::lexical_cast<std::string>( getMode() ) );
 
-        if( getMode() == 1 )
+        // each column is read with a single read
+        EventColumns columns;
+        readColumn( stream, columns.position, nev );
+        readColumn( stream, columns.type, nev );
+        if( getMode() == 3 )
+        {
+            readColumn( stream, columns.channel, nev );
+            readColumn( stream, columns.duration, nev );
+        }
+        setColumns( columns );
+    }
+
+    //-------------------------------------------------------------------------
+    void EventHeader::getColumns( EventColumns &columns ) const
+    {
+        if( m_mode == 1 )
         {
-            for( size_t i=0; i<nev; i++ )
+            size_t n = m_mode1.size( );
+            columns.position.resize( n );
+            columns.type.resize( n );
+            columns.channel.clear( );
+            columns.duration.clear( );
+            for( size_t i=0; i<n; i++ )
             {
-                Mode1Event e;
-                e.position = positions[i];
-                e.type = types[i];
-                addEvent( e );
+                columns.position[i] = m_mode1[i].position;
+                columns.type[i] = m_mode1[i].type;
             }
         }
-        else if( getMode() == 3 )
+        else if( m_mode == 3 )
         {
-            std::vector<uint16> channels;
-            std::vector<uint32> durations;
-            channels.resize( nev );
-            durations.resize( nev );
-            for( size_t i=0; i<nev; i++ )
-                readLittleEndian( stream, channels[i] );
-            for( size_t i=0; i<nev; i++ )
-                readLittleEndian( stream, durations[i] );
-            for( size_t i=0; i<nev; i++ )
+            size_t n = m_mode3.size( );
+            columns.position.resize( n );
+            columns.type.resize( n );
+            columns.channel.resize( n );
+            columns.duration.resize( n );
+            for( size_t i=0; i<n; i++ )
             {
-                Mode3Event e;
-                e.position = positions[i];
-                e.type = types[i];
-                e.channel = channels[i];
-                e.duration = durations[i];
-                addEvent( e );
+                columns.position[i] = m_mode3[i].position;
+                columns.type[i] = m_mode3[i].type;
+                columns.channel[i] = m_mode3[i].channel;
+                columns.duration[i] = m_mode3[i].duration;
             }
         }
         else
-            throw exception::invalid_eventmode( boost::lexical_cast<std::string>( getMode() ) );
+            throw exception::invalid_eventmode( boost::lexical_cast<std::string>( m_mode ) );
+    }
+
+    //-------------------------------------------------------------------------
+    void EventHeader::setColumns( const EventColumns &columns )
+    {
+        size_t n = columns.position.size( );
+        if( columns.type.size( ) != n )
+            throw exception::invalid_operation( "EventHeader::setColumns: columns differ in length." );
+        if( m_mode == 3 && ( columns.channel.size( ) != n || columns.duration.size( ) != n ) )
+            throw exception::invalid_operation( "EventHeader::setColumns: mode 3 requires channel and duration columns of equal length." );
+        if( n > GDF_MAXNUM_EVENTS )
+            throw exception::invalid_operation( "EventHeader::setColumns: too many events." );
+
+        if( m_mode == 1 )
+        {
+            m_mode3.clear( );
+            m_mode1.resize( n );
+            for( size_t i=0; i<n; i++ )
+            {
+                m_mode1[i].position = columns.position[i];
+                m_mode1[i].type = columns.type[i];
+            }
+        }
+        else if( m_mode == 3 )
+        {
+            m_mode1.clear( );
+            m_mode3.resize( n );
+            for( size_t i=0; i<n; i++ )
+            {
+                m_mode3[i].position = columns.position[i];
+                m_mode3[i].type = columns.type[i];
+                m_mode3[i].channel = columns.channel[i];
+                m_mode3[i].duration = columns.duration[i];
+            }
+        }
+        else
+            throw exception::invalid_eventmode( boost::lexical_cast<std::string>( m_mode ) );
+        invalidateIndex( );
     }
 
     void EventHeader::setMode( uint8 mode )
@@ -194,19 +253,90 @@ namespace gdf
 	//-------------------------------------------------------------------------
 	std::vector<uint32> EventHeader::getSparseSamples (const size_t chan_idx)
 	{
-		std::vector<uint32> index_list;
-		unsigned int num_events = this->getNumEvents();
-		// loop over all mode 3 events
-		for(unsigned int m = 0; m < num_events; m++)
-		{
-			if( (m_mode3[m].channel == chan_idx) && (m_mode3[m].type == 0x7fff) )
-			{
-				index_list.push_back( m );
-			}
-		}
+		if( m_mode != 3 || chan_idx > 0xFFFF )
+			return std::vector<uint32>( );
+		EventRange range = getSparseSampleRange( static_cast<uint16>( chan_idx ) );
+		// in order of the event table
+		std::vector<uint32> index_list( range.begin( ), range.end( ) );
+		std::sort( index_list.begin( ), index_list.end( ) );
 		return index_list;
 	}
 
+    //-------------------------------------------------------------------------
+    void EventHeader::buildIndex( ) const
+    {
+        if( m_index_valid )
+            return;
+
+        m_type_index.clear( );
+        m_channel_index.clear( );
+        if( m_mode == 1 )
+        {
+            for( size_t i=0; i<m_mode1.size(); i++ )
+                m_type_index[m_mode1[i].type].push_back( static_cast<uint32>( i ) );
+        }
+        else if( m_mode == 3 )
+        {
+            for( size_t i=0; i<m_mode3.size(); i++ )
+            {
+                m_type_index[m_mode3[i].type].push_back( static_cast<uint32>( i ) );
+                m_channel_index[std::make_pair( m_mode3[i].type, m_mode3[i].channel )].push_back( static_cast<uint32>( i ) );
+            }
+        }
+
+        // buckets are in event table order; a stable sort keeps that order for equal positions
+        EventPositionLess less( m_mode == 1 ? &m_mode1 : NULL, m_mode == 1 ? NULL : &m_mode3 );
+        for( TypeIndex::iterator it = m_type_index.begin( ); it != m_type_index.end( ); it++ )
+            std::stable_sort( it->second.begin( ), it->second.end( ), less );
+        for( ChannelIndex::iterator it = m_channel_index.begin( ); it != m_channel_index.end( ); it++ )
+            std::stable_sort( it->second.begin( ), it->second.end( ), less );
+
+        m_index_valid = true;
+    }
+
+    //-------------------------------------------------------------------------
+    EventRange EventHeader::findRange( const std::vector<uint32> &bucket, uint32 begin_pos, uint32 end_pos ) const
+    {
+        if( bucket.empty( ) || begin_pos >= end_pos )
+            return EventRange( );
+
+        // binary search on the positions of the indexed events
+        size_t lo = 0, hi = bucket.size( );
+        while( lo < hi )
+        {
+            size_t mid = lo + ( hi - lo ) / 2;
+            if( getPosition( bucket[mid] ) < begin_pos ) lo = mid + 1; else hi = mid;
+        }
+        size_t first = lo;
+        hi = bucket.size( );
+        while( lo < hi )
+        {
+            size_t mid = lo + ( hi - lo ) / 2;
+            if( getPosition( bucket[mid] ) < end_pos ) lo = mid + 1; else hi = mid;
+        }
+        return EventRange( &bucket[0] + first, &bucket[0] + lo );
+    }
+
+    //-------------------------------------------------------------------------
+    EventRange EventHeader::getEvents( uint16 type, uint32 begin_pos, uint32 end_pos ) const
+    {
+        buildIndex( );
+        TypeIndex::const_iterator it = m_type_index.find( type );
+        if( it == m_type_index.end( ) )
+            return EventRange( );
+        return findRange( it->second, begin_pos, end_pos );
+    }
+
+    //-------------------------------------------------------------------------
+    EventRange EventHeader::getChannelEvents( uint16 type, uint16 channel, uint32 begin_pos, uint32 end_pos ) const
+    {
+        buildIndex( );
+        ChannelIndex::const_iterator it = m_channel_index.find( std::make_pair( type, channel ) );
+        if( it == m_channel_index.end( ) )
+            return EventRange( );
+        return findRange( it->second, begin_pos, end_pos );
+    }
+
     //-------------------------------------------------------------------------
     void EventHeader::getEvent( uint32 index, Mode1Event &ev )
     {
@@ -227,6 +357,7 @@ namespace gdf
         if( m_mode != 1 )
             throw exception::wrong_eventmode( "Expecting mode 1" );
         m_mode1.push_back( ev );
+        invalidateIndex( );
     }
 
     void EventHeader::addEvent( const Mode3Event &ev )
@@ -234,6 +365,7 @@ namespace gdf
         if( m_mode != 3 )
             throw exception::wrong_eventmode( "Expecting mode 3" );
         m_mode3.push_back( ev );
+        invalidateIndex( );
     }
 
     uint32 EventHeader::secToPos( const double sample_time_sec )
@@ -251,27 +383,18 @@ namespace gdf
         return pos;
     }
 
-    double EventHeader::posToSec( const uint32 event_pos ) const
-    {
-        if( m_efs <= 0 )
-            throw exception::invalid_operation( "Event table m_efs not set or not valid." );
-        int32 raw_pos = event_pos - 1; // "-1" is for "one-based indexing" see EventHeader::secToPos
-        if( raw_pos < 0 )
-            throw exception::invalid_operation( "Event time < 0 [sec] not allowed." );
-        double event_time_sec = raw_pos * 1.0 / m_efs; 
-        return event_time_sec;
-    }
-
     void EventHeader::sort( )
     {
         std::sort( m_mode1.begin(), m_mode1.end() );
         std::sort( m_mode3.begin(), m_mode3.end() );
+        invalidateIndex( );
     }
 
     void EventHeader::clear( )
     {
         m_mode1.clear( );
         m_mode3.clear( );
+        invalidateIndex( );
     }
 
 }
@@ -0,0 +1,146 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "GDF/EventTableView.h"
+#include "GDF/DataSource.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+namespace gdf
+{
+    EventTableView::EventTableView( const std::string &filename, uint64 offset )
+        : m_mapping( NULL ), m_region( NULL ), m_mode( 1 ), m_efs( -1 ), m_num_events( 0 )
+    {
+        using namespace boost::interprocess;
+
+        uint64 file_size = FileSource( filename ).size( );
+        if( file_size <= offset )
+            return;     // no event table
+        if( file_size < offset + 8 )
+            throw exception::serialization_error( "event table header is truncated" );
+
+        m_mapping = new file_mapping( filename.c_str( ), read_only );
+        m_region = new mapped_region( *m_mapping, read_only, boost::numeric_cast<offset_t>( offset ), boost::numeric_cast<size_t>( file_size - offset ) );
+        try
+        {
+            init( static_cast<const char*>( m_region->get_address( ) ), file_size - offset );
+        }
+        catch( ... )
+        {
+            delete m_region;
+            delete m_mapping;
+            m_region = NULL;
+            m_mapping = NULL;
+            throw;
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    EventTableView::EventTableView( const DataSource &source, uint64 offset )
+        : m_mapping( NULL ), m_region( NULL ), m_mode( 1 ), m_efs( -1 ), m_num_events( 0 )
+    {
+        uint64 source_size = source.size( );
+        if( source_size <= offset )
+            return;     // no event table
+        if( source_size < offset + 8 )
+            throw exception::serialization_error( "event table header is truncated" );
+
+        if( source.data( ) != NULL )
+        {
+            init( source.data( ) + offset, source_size - offset );
+            return;
+        }
+
+        m_copy.resize( boost::numeric_cast<size_t>( source_size - offset ) );
+        source.readAt( offset, &m_copy[0], m_copy.size( ) );
+        init( &m_copy[0], m_copy.size( ) );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void EventTableView::init( const char *table, uint64 available )
+    {
+        m_mode = static_cast<uint8>( table[0] );
+        const uint8 *n = reinterpret_cast<const uint8*>( table + 1 );
+        m_num_events = n[0] + n[1]*256 + n[2]*65536;
+        readLittleEndian( table + 4, m_efs );
+
+        size_t bytes_per_event;
+        switch( m_mode )
+        {
+        case 1: bytes_per_event = 6; break;
+        case 3: bytes_per_event = 12; break;
+        default:
+            throw exception::invalid_eventmode( boost::lexical_cast<std::string>( static_cast<int>( m_mode ) ) );
+        }
+        if( available < 8 + uint64( m_num_events ) * bytes_per_event )
+            throw exception::serialization_error( "event table is truncated" );
+
+        const char *column = table + 8;
+        m_positions = EventColumnView<uint32>( column, m_num_events );
+        column += m_num_events * sizeof(uint32);
+        m_types = EventColumnView<uint16>( column, m_num_events );
+        column += m_num_events * sizeof(uint16);
+        if( m_mode == 3 )
+        {
+            m_channels = EventColumnView<uint16>( column, m_num_events );
+            column += m_num_events * sizeof(uint16);
+            m_durations = EventColumnView<uint32>( column, m_num_events );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    EventTableView::~EventTableView( )
+    {
+        delete m_region;
+        delete m_mapping;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void EventTableView::getEvent( uint32 index, Mode1Event &ev ) const
+    {
+        if( index >= m_num_events )
+            throw exception::index_out_of_range( boost::lexical_cast<std::string>( index ) );
+        ev.position = m_positions[index];
+        ev.type = m_types[index];
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void EventTableView::getEvent( uint32 index, Mode3Event &ev ) const
+    {
+        if( m_mode != 3 )
+            throw exception::wrong_eventmode( "Expecting mode 3" );
+        if( index >= m_num_events )
+            throw exception::index_out_of_range( boost::lexical_cast<std::string>( index ) );
+        ev.position = m_positions[index];
+        ev.type = m_types[index];
+        ev.channel = m_channels[index];
+        ev.duration = m_durations[index];
+    }
+}
@@ -23,7 +23,26 @@
 #include <boost/numeric/conversion/cast.hpp>
 #include <list>
 #include <string>
+#include <vector>
 
+/// Offset of field NAME of signal i in the column-wise signal header block of ns signals
+#define GDF_SIGNAL_COLUMN_OFFSET( SH, NAME, i ) ( SH.NAME.pos * ns + i * sizeof(SH.NAME.item) )
+
+/// Encode field NAME of all signal headers into the signal header block sig
+#define GDF_WRITE_SIGNAL_COLUMN( NAME ) \
+        for( uint16 i=0; i<ns; i++ ) \
+        { \
+            const SignalHeader &sh = hdr.getSignalHeader_readonly( i ); \
+            sh.NAME.tobuffer( sig + GDF_SIGNAL_COLUMN_OFFSET( sh, NAME, i ) ); \
+        }
+
+/// Decode field NAME of all signal headers from the signal header block sig
+#define GDF_READ_SIGNAL_COLUMN( NAME ) \
+        for( uint16 i=0; i<ns; i++ ) \
+        { \
+            SignalHeader &sh = hdr.getSignalHeader( i ); \
+            sh.NAME.frombuffer( sig + GDF_SIGNAL_COLUMN_OFFSET( sh, NAME, i ) ); \
+        }
 
 namespace gdf
 {
@@ -347,52 +366,58 @@ namespace gdf
     std::ostream& operator<< (std::ostream& out, const GDFHeaderAccess& hdr)
     {
         const MainHeader *mh = &hdr.m_mainhdr;
-        mh->version_id.tostream( out );
-        mh->patient_id.tostream( out );
-        mh->reserved_1.tostream( out );
-        mh->patient_drugs.tostream( out );
-        mh->patient_weight.tostream( out );
-        mh->patient_height.tostream( out );
-        mh->patient_flags.tostream( out );
-        mh->recording_id.tostream( out );
-        mh->recording_location.tostream( out );
-        mh->recording_start.tostream( out );
-        mh->patient_birthday.tostream( out );
-        mh->header_length.tostream( out );
-        mh->patient_ICD.tostream( out );
-        mh->equipment_provider_classification.tostream( out );
-        mh->reserved_2.tostream( out );
-        mh->patient_headsize.tostream( out );
-        mh->pos_reference.tostream( out );
-        mh->pos_ground.tostream( out );
-        mh->num_datarecords.tostream( out );
-        mh->datarecord_duration.tostream( out );
-        mh->num_signals.tostream( out );
-        mh->reserved_3.tostream( out );
-
-        assert( out.tellp() == std::streampos(256) );
-
         size_t ns = mh->get_num_signals( );
 
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).label.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).transducer_type.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).physical_dimension.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).physical_dimension_code.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).physmin.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).physmax.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).digmin.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).digmax.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).reserved_1.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).lowpass.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).highpass.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).notch.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).samples_per_record.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).datatype.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).sensor_pos.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).sensor_info.tostream( out );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader_readonly(i).reserved_2.tostream( out );
-
-        assert( out.tellp() == std::streampos(256+256*ns) );
+        // fixed header and signal headers are assembled in memory and written at once
+        std::vector<char> block( 256 * ( 1 + ns ), 0 );
+        char *buf = &block[0];
+        mh->version_id.tobuffer( buf + mh->version_id.pos );
+        mh->patient_id.tobuffer( buf + mh->patient_id.pos );
+        mh->reserved_1.tobuffer( buf + mh->reserved_1.pos );
+        mh->patient_drugs.tobuffer( buf + mh->patient_drugs.pos );
+        mh->patient_weight.tobuffer( buf + mh->patient_weight.pos );
+        mh->patient_height.tobuffer( buf + mh->patient_height.pos );
+        mh->patient_flags.tobuffer( buf + mh->patient_flags.pos );
+        mh->recording_id.tobuffer( buf + mh->recording_id.pos );
+        mh->recording_location.tobuffer( buf + mh->recording_location.pos );
+        mh->recording_start.tobuffer( buf + mh->recording_start.pos );
+        mh->patient_birthday.tobuffer( buf + mh->patient_birthday.pos );
+        mh->header_length.tobuffer( buf + mh->header_length.pos );
+        mh->patient_ICD.tobuffer( buf + mh->patient_ICD.pos );
+        mh->equipment_provider_classification.tobuffer( buf + mh->equipment_provider_classification.pos );
+        mh->reserved_2.tobuffer( buf + mh->reserved_2.pos );
+        mh->patient_headsize.tobuffer( buf + mh->patient_headsize.pos );
+        mh->pos_reference.tobuffer( buf + mh->pos_reference.pos );
+        mh->pos_ground.tobuffer( buf + mh->pos_ground.pos );
+        mh->num_datarecords.tobuffer( buf + mh->num_datarecords.pos );
+        mh->datarecord_duration.tobuffer( buf + mh->datarecord_duration.pos );
+        mh->num_signals.tobuffer( buf + mh->num_signals.pos );
+        mh->reserved_3.tobuffer( buf + mh->reserved_3.pos );
+
+        // signal header fields are stored column-wise
+        char *sig = buf + 256;
+        GDF_WRITE_SIGNAL_COLUMN( label );
+        GDF_WRITE_SIGNAL_COLUMN( transducer_type );
+        GDF_WRITE_SIGNAL_COLUMN( physical_dimension );
+        GDF_WRITE_SIGNAL_COLUMN( physical_dimension_code );
+        GDF_WRITE_SIGNAL_COLUMN( physmin );
+        GDF_WRITE_SIGNAL_COLUMN( physmax );
+        GDF_WRITE_SIGNAL_COLUMN( digmin );
+        GDF_WRITE_SIGNAL_COLUMN( digmax );
+        GDF_WRITE_SIGNAL_COLUMN( reserved_1 );
+        GDF_WRITE_SIGNAL_COLUMN( lowpass );
+        GDF_WRITE_SIGNAL_COLUMN( highpass );
+        GDF_WRITE_SIGNAL_COLUMN( notch );
+        GDF_WRITE_SIGNAL_COLUMN( samples_per_record );
+        GDF_WRITE_SIGNAL_COLUMN( datatype );
+        GDF_WRITE_SIGNAL_COLUMN( sensor_pos );
+        GDF_WRITE_SIGNAL_COLUMN( sensor_info );
+        GDF_WRITE_SIGNAL_COLUMN( reserved_2 );
+
+        std::streampos start = out.tellp( );
+        out.write( buf, block.size( ) );
+        assert( out.tellp() == start + std::streamoff( block.size( ) ) );
+        (void)start;
 
         // write GDF header 3
         hdr.getTagHeader_readonly( ).toStream( out );
@@ -411,7 +436,14 @@ namespace gdf
         hdr.clear( );
 
         MainHeader *mh = &hdr.m_mainhdr;
-        mh->version_id.fromstream( in );
+
+        // fixed header
+        char buf[256];
+        in.read( buf, sizeof(buf) );
+        if( in.fail( ) )
+            throw exception::serialization_error( "unexpected end of file while reading the fixed header" );
+
+        mh->version_id.frombuffer( buf + mh->version_id.pos );
         int gdf_version_int = mh->getGdfVersionInt();
 #ifdef ALLOW_GDF_V_251
         if (gdf_version_int < 210 || gdf_version_int > 251)
@@ -420,54 +452,61 @@ namespace gdf
 #endif
             throw exception::incompatible_gdf_version (mh->get_version_id ());
 
-        mh->patient_id.fromstream( in );
-        mh->reserved_1.fromstream( in );
-        mh->patient_drugs.fromstream( in );
-        mh->patient_weight.fromstream( in );
-        mh->patient_height.fromstream( in );
-        mh->patient_flags.fromstream( in );
-        mh->recording_id.fromstream( in );
-        mh->recording_location.fromstream( in );
-        mh->recording_start.fromstream( in );
-        mh->patient_birthday.fromstream( in );
-        mh->header_length.fromstream( in );
-        mh->patient_ICD.fromstream( in );
-        mh->equipment_provider_classification.fromstream( in );
-        mh->reserved_2.fromstream( in );
-        mh->patient_headsize.fromstream( in );
-        mh->pos_reference.fromstream( in );
-        mh->pos_ground.fromstream( in );
-        mh->num_datarecords.fromstream( in );
-        mh->datarecord_duration.fromstream( in );
-        mh->num_signals.fromstream( in );
-        mh->reserved_3.fromstream( in );
-
-        assert( in.tellg() == std::streampos(256) );
+        mh->patient_id.frombuffer( buf + mh->patient_id.pos );
+        mh->reserved_1.frombuffer( buf + mh->reserved_1.pos );
+        mh->patient_drugs.frombuffer( buf + mh->patient_drugs.pos );
+        mh->patient_weight.frombuffer( buf + mh->patient_weight.pos );
+        mh->patient_height.frombuffer( buf + mh->patient_height.pos );
+        mh->patient_flags.frombuffer( buf + mh->patient_flags.pos );
+        mh->recording_id.frombuffer( buf + mh->recording_id.pos );
+        mh->recording_location.frombuffer( buf + mh->recording_location.pos );
+        mh->recording_start.frombuffer( buf + mh->recording_start.pos );
+        mh->patient_birthday.frombuffer( buf + mh->patient_birthday.pos );
+        mh->header_length.frombuffer( buf + mh->header_length.pos );
+        mh->patient_ICD.frombuffer( buf + mh->patient_ICD.pos );
+        mh->equipment_provider_classification.frombuffer( buf + mh->equipment_provider_classification.pos );
+        mh->reserved_2.frombuffer( buf + mh->reserved_2.pos );
+        mh->patient_headsize.frombuffer( buf + mh->patient_headsize.pos );
+        mh->pos_reference.frombuffer( buf + mh->pos_reference.pos );
+        mh->pos_ground.frombuffer( buf + mh->pos_ground.pos );
+        mh->num_datarecords.frombuffer( buf + mh->num_datarecords.pos );
+        mh->datarecord_duration.frombuffer( buf + mh->datarecord_duration.pos );
+        mh->num_signals.frombuffer( buf + mh->num_signals.pos );
+        mh->reserved_3.frombuffer( buf + mh->reserved_3.pos );
 
         size_t ns = mh->get_num_signals( );
 
         for( uint16 i=0; i<ns; i++ )
             hdr.createSignal( i );
 
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).label.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).transducer_type.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).physical_dimension.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).physical_dimension_code.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).physmin.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).physmax.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).digmin.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).digmax.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).reserved_1.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).lowpass.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).highpass.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).notch.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).samples_per_record.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).datatype.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).sensor_pos.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).sensor_info.fromstream( in );
-        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).reserved_2.fromstream( in );
-
-        assert( in.tellg() == std::streampos(256+256*ns) );
+        // signal headers are read in one block and decoded column by column
+        std::vector<char> block( 256 * ns );
+        if( ns > 0 )
+        {
+            in.read( &block[0], block.size( ) );
+            if( in.fail( ) )
+                throw exception::serialization_error( "unexpected end of file while reading the signal headers" );
+
+            const char *sig = &block[0];
+            GDF_READ_SIGNAL_COLUMN( label );
+            GDF_READ_SIGNAL_COLUMN( transducer_type );
+            GDF_READ_SIGNAL_COLUMN( physical_dimension );
+            GDF_READ_SIGNAL_COLUMN( physical_dimension_code );
+            GDF_READ_SIGNAL_COLUMN( physmin );
+            GDF_READ_SIGNAL_COLUMN( physmax );
+            GDF_READ_SIGNAL_COLUMN( digmin );
+            GDF_READ_SIGNAL_COLUMN( digmax );
+            GDF_READ_SIGNAL_COLUMN( reserved_1 );
+            GDF_READ_SIGNAL_COLUMN( lowpass );
+            GDF_READ_SIGNAL_COLUMN( highpass );
+            GDF_READ_SIGNAL_COLUMN( notch );
+            GDF_READ_SIGNAL_COLUMN( samples_per_record );
+            GDF_READ_SIGNAL_COLUMN( datatype );
+            GDF_READ_SIGNAL_COLUMN( sensor_pos );
+            GDF_READ_SIGNAL_COLUMN( sensor_info );
+            GDF_READ_SIGNAL_COLUMN( reserved_2 );
+        }
+        for( uint16 i=0; i<ns; i++ ) hdr.getSignalHeader(i).updateCalibration( );
 
         // read GDF header 3
         uint16 header3LenBlocks = mh->get_header_length() - (1+ns);
@@ -53,7 +53,7 @@ namespace gdf
 
     void Modifier::close( )
     {
-        m_file.close( );
+        Reader::close( );
     }
 
     //===================================================================================================
@@ -138,10 +138,9 @@ namespace gdf
     {
         if( m_events == NULL )
         {
-            if( m_file.is_open() )
+            if( m_source != NULL )
             {
                 m_events = new EventHeader( );
-                m_file.seekg( m_event_offset );
                 readEvents( );
             }
             else
@@ -158,10 +157,9 @@ namespace gdf
     {
         if( m_events == NULL )
         {
-            if( m_file.is_open() )
+            if( m_source != NULL )
             {
                 m_events = new EventHeader( );
-                m_file.seekg( m_event_offset );
                 readEvents( );
             }
             else
@@ -0,0 +1,355 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "GDF/Overview.h"
+#include "GDF/Reader.h"
+#include <boost/lexical_cast.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <string.h>
+
+namespace gdf
+{
+    static const char OVERVIEW_MAGIC[8] = { 'G', 'D', 'F', 'O', 'V', 'R', '0', '1' };
+
+    /// Running summary of a bin
+    struct BinAccumulator
+    {
+        BinAccumulator( ) { clear( ); }
+
+        void clear( )
+        {
+            min = std::numeric_limits<double>::infinity( );
+            max = -std::numeric_limits<double>::infinity( );
+            sum = 0;
+            count = 0;
+            filled = 0;
+        }
+
+        void add( double x )
+        {
+            filled++;
+            if( x != x )
+                return;
+            min = std::min( min, x );
+            max = std::max( max, x );
+            sum += x;
+            count++;
+        }
+
+        void add( const BinAccumulator &other )
+        {
+            filled += other.filled;
+            min = std::min( min, other.min );
+            max = std::max( max, other.max );
+            sum += other.sum;
+            count += other.count;
+        }
+
+        OverviewBin bin( ) const
+        {
+            OverviewBin b;
+            if( count == 0 )
+            {
+                b.min = b.max = b.mean = std::numeric_limits<float32>::quiet_NaN( );
+                return b;
+            }
+            b.min = static_cast<float32>( min );
+            b.max = static_cast<float32>( max );
+            b.mean = static_cast<float32>( sum / count );
+            return b;
+        }
+
+        double min, max, sum;
+        uint64 count;   ///< number of non-NaN samples
+        uint64 filled;  ///< number of samples including NaN
+    };
+
+    /// Streaming pyramid of one channel: completed bins of a level are merged in pairs into the next level
+    class PyramidBuilder
+    {
+    public:
+        PyramidBuilder( size_t base ) : m_base( base ), m_pending( 1 ) { }
+
+        void add( const double *samples, size_t num )
+        {
+            for( size_t i=0; i<num; i++ )
+            {
+                m_pending[0].add( samples[i] );
+                if( m_pending[0].filled == m_base )
+                    push( 0 );
+            }
+        }
+
+        /// Flush the partial bins of all levels up to the first level with a single bin
+        void finish( std::vector< std::vector<OverviewBin> > &levels )
+        {
+            for( size_t k=0; k<m_pending.size(); k++ )
+            {
+                if( m_pending[k].filled > 0 )
+                    store( k );
+                if( m_levels.size( ) > k && m_levels[k].size( ) == 1 )
+                {
+                    m_levels.resize( k + 1 );
+                    break;
+                }
+            }
+            levels.swap( m_levels );
+        }
+
+    private:
+        /// store the bin of level k and merge it into level k+1
+        void store( size_t k )
+        {
+            if( m_levels.size( ) <= k )
+                m_levels.resize( k + 1 );
+            if( m_pending.size( ) <= k + 1 )
+                m_pending.resize( k + 2 );
+            m_levels[k].push_back( m_pending[k].bin( ) );
+            m_pending[k+1].add( m_pending[k] );
+            m_pending[k].clear( );
+        }
+
+        /// level k bin is complete
+        void push( size_t k )
+        {
+            store( k );
+            if( m_pending[k+1].filled == ( m_base << ( k + 1 ) ) )
+                push( k + 1 );
+        }
+
+        size_t m_base;
+        std::vector<BinAccumulator> m_pending;
+        std::vector< std::vector<OverviewBin> > m_levels;
+    };
+
+    /// Passes record blocks to one PyramidBuilder per channel
+    class PyramidBlockHandler : public RecordBlockHandler
+    {
+    public:
+        PyramidBlockHandler( std::vector<PyramidBuilder> &builders, const std::vector<size_t> &spr ) : m_builders( builders ), m_spr( spr ) { }
+
+        void processBlock( size_t /*first_record*/, size_t num_records, const std::vector<double*> &channels )
+        {
+            for( size_t i=0; i<m_builders.size(); i++ )
+                if( channels[i] != NULL )
+                    m_builders[i].add( channels[i], num_records * m_spr[i] );
+        }
+
+    private:
+        std::vector<PyramidBuilder> &m_builders;
+        const std::vector<size_t> &m_spr;
+    };
+
+    //===================================================================================================
+    //===================================================================================================
+
+    Overview::Overview( ) : m_base( 0 )
+    {
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    Overview::~Overview( )
+    {
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Overview::build( Reader &reader, const std::string &filename, size_t base_bin_size )
+    {
+        if( base_bin_size == 0 )
+            throw exception::invalid_operation( "Overview::build: base_bin_size must not be 0." );
+
+        size_t ns = reader.getMainHeader_readonly( ).get_num_signals( );
+        size_t num_records = boost::numeric_cast<size_t>( reader.getMainHeader_readonly( ).get_num_datarecords( ) );
+        std::vector<size_t> spr( ns );
+        for( size_t i=0; i<ns; i++ )
+            spr[i] = reader.getSignalHeader_readonly( i ).get_samples_per_record( );
+
+        // open the output first, so an unwritable path fails before the decode pass
+        std::ofstream file( filename.c_str( ), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+        if( file.fail( ) )
+            throw exception::serialization_error( "can not write overview file " + filename );
+
+        // a single pass over the records, in blocks
+        std::vector<PyramidBuilder> builders( ns, PyramidBuilder( base_bin_size ) );
+        PyramidBlockHandler handler( builders, spr );
+        reader.readRecordBlocks( handler );
+
+        std::vector< std::vector< std::vector<OverviewBin> > > levels( ns );
+        for( size_t i=0; i<ns; i++ )
+            builders[i].finish( levels[i] );
+
+        // header: magic, number of channels, base bin size, then per channel the number of samples and bins per level
+        file.write( OVERVIEW_MAGIC, sizeof(OVERVIEW_MAGIC) );
+        writeLittleEndian( file, boost::numeric_cast<uint32>( ns ) );
+        writeLittleEndian( file, boost::numeric_cast<uint32>( base_bin_size ) );
+        for( size_t i=0; i<ns; i++ )
+        {
+            writeLittleEndian( file, uint64( spr[i] ) * num_records );
+            writeLittleEndian( file, boost::numeric_cast<uint32>( levels[i].size( ) ) );
+            for( size_t k=0; k<levels[i].size(); k++ )
+                writeLittleEndian( file, uint64( levels[i][k].size( ) ) );
+        }
+        for( size_t i=0; i<ns; i++ )
+            for( size_t k=0; k<levels[i].size(); k++ )
+                for( size_t b=0; b<levels[i][k].size(); b++ )
+                {
+                    writeLittleEndian( file, levels[i][k][b].min );
+                    writeLittleEndian( file, levels[i][k][b].max );
+                    writeLittleEndian( file, levels[i][k][b].mean );
+                }
+
+        if( file.fail( ) )
+            throw exception::serialization_error( "can not write overview file " + filename );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Overview::open( const std::string &filename )
+    {
+        std::ifstream file( filename.c_str( ), std::ios_base::in | std::ios_base::binary );
+        if( file.fail( ) )
+            throw exception::file_exists_not( filename );
+
+        char magic[sizeof(OVERVIEW_MAGIC)];
+        file.read( magic, sizeof(magic) );
+        if( file.fail( ) || memcmp( magic, OVERVIEW_MAGIC, sizeof(magic) ) != 0 )
+            throw exception::serialization_error( filename + " is not an overview file" );
+
+        uint32 ns, base;
+        readLittleEndian( file, ns );
+        readLittleEndian( file, base );
+        std::vector<ChannelOverview> channels( ns );
+        for( size_t i=0; i<ns; i++ )
+        {
+            uint32 num_levels;
+            readLittleEndian( file, channels[i].num_samples );
+            readLittleEndian( file, num_levels );
+            if( file.fail( ) || num_levels > 64 )
+                throw exception::serialization_error( "corrupt overview file " + filename );
+            channels[i].levels.resize( num_levels );
+            for( size_t k=0; k<num_levels; k++ )
+            {
+                uint64 num_bins;
+                readLittleEndian( file, num_bins );
+                if( file.fail( ) || num_bins > channels[i].num_samples )
+                    throw exception::serialization_error( "corrupt overview file " + filename );
+                channels[i].levels[k].resize( boost::numeric_cast<size_t>( num_bins ) );
+            }
+        }
+
+        // the bins of all levels are stored back to back
+        for( size_t i=0; i<ns; i++ )
+            for( size_t k=0; k<channels[i].levels.size(); k++ )
+            {
+                std::vector<OverviewBin> &bins = channels[i].levels[k];
+                if( bins.empty( ) )
+                    continue;
+                std::vector<char> raw( bins.size( ) * 3 * sizeof(float32) );
+                file.read( &raw[0], raw.size( ) );
+                if( file.fail( ) )
+                    throw exception::serialization_error( "overview file " + filename + " is truncated" );
+                for( size_t b=0; b<bins.size(); b++ )
+                {
+                    readLittleEndian( &raw[( 3*b + 0 )*sizeof(float32)], bins[b].min );
+                    readLittleEndian( &raw[( 3*b + 1 )*sizeof(float32)], bins[b].max );
+                    readLittleEndian( &raw[( 3*b + 2 )*sizeof(float32)], bins[b].mean );
+                }
+            }
+
+        m_base = base;
+        m_channels.swap( channels );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    const Overview::ChannelOverview &Overview::getChannel( uint16 channel ) const
+    {
+        if( channel >= m_channels.size( ) )
+            throw exception::nonexistent_channel_access( boost::lexical_cast<std::string>( channel ) );
+        return m_channels[channel];
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    uint64 Overview::getNumSamples( uint16 channel ) const
+    {
+        return getChannel( channel ).num_samples;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t Overview::getNumLevels( uint16 channel ) const
+    {
+        return getChannel( channel ).levels.size( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    const std::vector<OverviewBin> &Overview::getLevel( uint16 channel, size_t level ) const
+    {
+        const ChannelOverview &c = getChannel( channel );
+        if( level >= c.levels.size( ) )
+            throw exception::index_out_of_range( "overview level " + boost::lexical_cast<std::string>( level ) );
+        return c.levels[level];
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t Overview::selectLevel( uint16 channel, uint64 num_samples, size_t pixels ) const
+    {
+        const ChannelOverview &c = getChannel( channel );
+        size_t level = 0;
+        while( level + 1 < c.levels.size( ) && uint64( getBinSize( level + 1 ) ) * std::max( pixels, size_t(1) ) <= num_samples )
+            level++;
+        return level;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t Overview::query( uint16 channel, uint64 start, uint64 end, size_t pixels, std::vector<OverviewBin> &bins ) const
+    {
+        bins.clear( );
+        const ChannelOverview &c = getChannel( channel );
+        end = std::min( end, c.num_samples );
+        if( c.levels.empty( ) || end <= start )
+            return getBinSize( 0 );
+
+        size_t level = selectLevel( channel, end - start, pixels );
+        const std::vector<OverviewBin> &lv = c.levels[level];
+        uint64 bin_size = getBinSize( level );
+        size_t first = boost::numeric_cast<size_t>( start / bin_size );
+        size_t last = std::min( boost::numeric_cast<size_t>( ( end - 1 ) / bin_size + 1 ), lv.size( ) );
+        if( first < last )
+            bins.assign( lv.begin( ) + first, lv.begin( ) + last );
+        return boost::numeric_cast<size_t>( bin_size );
+    }
+}
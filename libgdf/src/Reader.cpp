@@ -17,282 +17,1587 @@
 // Copyright 2010, 2013 Martin Billinger, Owen Kelly
 
 #include "GDF/Reader.h"
+#include "GDF/Conversion.h"
+#include "GDF/DataSource.h"
 #include "GDF/tools.h"
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <algorithm>
+#include <deque>
+#include <limits>
 //#include <iostream>
 
 namespace gdf
 {
+    /// Minimum number of samples per thread for decoding in parallel
+    static const size_t PARALLEL_MIN_SAMPLES = 4096;
+
+    /// Number of samples of all channels together per block in Reader::readRecordBlocks
+    static const size_t RECORD_BLOCK_SAMPLES = 4*1024*1024;
+
+    /// Background thread that reads and decodes records ahead of a sequential consumer
+    class Reader::Prefetcher
+    {
+    public:
+        Prefetcher( const DataSource &source, const GDFHeaderAccess *header, size_t record_offset, size_t record_length,
+                    size_t num_records, size_t depth )
+            : m_source( source ), m_record_offset( record_offset ), m_record_length( record_length ), m_num_records( num_records ),
+              m_depth( depth ), m_stop( false ), m_generation( 0 ), m_next( 0 ), m_limit( 0 ), m_inflight( NONE ), m_last( NONE )
+        {
+            for( size_t i=0; i<=depth; i++ )
+                m_pool.push_back( new Record( header ) );
+            m_thread = new boost::thread( boost::bind( &Prefetcher::run, this ) );
+        }
+
+        ~Prefetcher( )
+        {
+            {
+                boost::mutex::scoped_lock lock( m_mutex );
+                m_stop = true;
+                m_cond.notify_all( );
+            }
+            m_thread->join( );
+            delete m_thread;
+            for( size_t i=0; i<m_pool.size(); i++ )
+                delete m_pool[i];
+            for( std::map<size_t,Record*>::iterator it=m_ready.begin(); it!=m_ready.end(); it++ )
+                delete it->second;
+        }
+
+        /// Called by the consumer for each record it has to load. Returns the record if it was read ahead, NULL otherwise.
+        /** The caller takes ownership of the returned Record and must hand a Record back with recycle(). */
+        Record *take( size_t index )
+        {
+            boost::mutex::scoped_lock lock( m_mutex );
+            bool sequential = m_last != NONE && index == m_last + 1;
+            m_last = index;
+
+            Record *r = NULL;
+            if( sequential )
+            {
+                while( m_inflight == index )
+                    m_cond.wait( lock );
+                std::map<size_t,Record*>::iterator it = m_ready.find( index );
+                if( it != m_ready.end( ) )
+                {
+                    r = it->second;
+                    m_ready.erase( it );
+                }
+            }
+            else
+                m_generation++;
+
+            // drop records the consumer has skipped
+            while( !m_ready.empty( ) && ( !sequential || m_ready.begin( )->first <= index ) )
+            {
+                m_pool.push_back( m_ready.begin( )->second );
+                m_ready.erase( m_ready.begin( ) );
+            }
+
+            if( !sequential || m_next <= index )
+                m_next = index + 1;
+            m_limit = sequential ? std::min( index + 1 + m_depth, m_num_records ) : index + 1;
+            m_cond.notify_all( );
+            return r;
+        }
+
+        /// Returns the record if it has been read ahead, NULL otherwise. Does not change what is read ahead.
+        /** The caller takes ownership of the returned Record and must hand a Record back with recycle(). */
+        Record *claim( size_t index )
+        {
+            boost::mutex::scoped_lock lock( m_mutex );
+            std::map<size_t,Record*>::iterator it = m_ready.find( index );
+            if( it == m_ready.end( ) )
+                return NULL;
+            Record *r = it->second;
+            m_ready.erase( it );
+            return r;
+        }
+
+        /// Give a Record back to the pool
+        void recycle( Record *r )
+        {
+            boost::mutex::scoped_lock lock( m_mutex );
+            m_pool.push_back( r );
+            m_cond.notify_all( );
+        }
+
+    private:
+        void run( )
+        {
+            std::vector<char> buffer( std::max( m_record_length, size_t(1) ) );
+            boost::unique_lock<boost::mutex> lock( m_mutex );
+            while( true )
+            {
+                while( !m_stop && !( m_next < m_limit && !m_pool.empty( ) ) )
+                    m_cond.wait( lock );
+                if( m_stop )
+                    break;
+
+                size_t index = m_next++;
+                size_t generation = m_generation;
+                Record *r = m_pool.back( );
+                m_pool.pop_back( );
+                m_inflight = index;
+
+                lock.unlock( );
+                bool ok = true;
+                try
+                {
+                    m_source.readAt( m_record_offset + static_cast<uint64>( m_record_length ) * index, &buffer[0], m_record_length );
+                    r->frombuffer( &buffer[0] );
+                }
+                catch( std::exception & )
+                {
+                    ok = false; // the consumer reads the record itself and gets the error
+                }
+                lock.lock( );
+
+                m_inflight = NONE;
+                if( ok && generation == m_generation && index > m_last )
+                    m_ready[index] = r;
+                else
+                    m_pool.push_back( r );
+                m_cond.notify_all( );
+            }
+        }
+
+        static const size_t NONE = static_cast<size_t>( -1 );
+
+        const DataSource &m_source;
+        size_t m_record_offset, m_record_length, m_num_records, m_depth;
+
+        boost::thread *m_thread;
+        boost::mutex m_mutex;
+        boost::condition_variable m_cond;
+        bool m_stop;
+        size_t m_generation;    /// Incremented on every non-sequential access
+        size_t m_next;          /// Next record to read ahead
+        size_t m_limit;         /// Read ahead up to (excluding) this record
+        size_t m_inflight;      /// Record currently being read by the thread
+        size_t m_last;          /// Record most recently requested by the consumer
+        std::vector<Record*> m_pool;
+        std::map<size_t,Record*> m_ready;
+    };
+
+    //===================================================================================================
+    //===================================================================================================
+
+    /// Threads that decode record blocks for getSignals() and getSignal()
+    class Reader::WorkerPool
+    {
+    public:
+        WorkerPool( size_t num_threads ) : m_active( 0 ), m_stop( false )
+        {
+            for( size_t i=0; i<num_threads; i++ )
+                m_threads.create_thread( boost::bind( &WorkerPool::run, this ) );
+        }
+
+        ~WorkerPool( )
+        {
+            {
+                boost::mutex::scoped_lock lock( m_mutex );
+                m_stop = true;
+                m_cond.notify_all( );
+            }
+            m_threads.join_all( );
+        }
+
+        /// Queue a task; returns immediately
+        void submit( const boost::function<void()> &task )
+        {
+            boost::mutex::scoped_lock lock( m_mutex );
+            m_tasks.push_back( task );
+            m_cond.notify_one( );
+        }
+
+        /// Wait until all queued tasks have finished. Rethrows the first exception thrown by a task.
+        void wait( )
+        {
+            boost::mutex::scoped_lock lock( m_mutex );
+            while( !m_tasks.empty( ) || m_active > 0 )
+                m_done.wait( lock );
+            if( m_error )
+            {
+                boost::exception_ptr error = m_error;
+                m_error = boost::exception_ptr( );
+                boost::rethrow_exception( error );
+            }
+        }
+
+    private:
+        void run( )
+        {
+            boost::unique_lock<boost::mutex> lock( m_mutex );
+            while( true )
+            {
+                while( !m_stop && m_tasks.empty( ) )
+                    m_cond.wait( lock );
+                if( m_stop )
+                    break;
+
+                boost::function<void()> task = m_tasks.front( );
+                m_tasks.pop_front( );
+                m_active++;
+
+                lock.unlock( );
+                boost::exception_ptr error;
+                try
+                {
+                    task( );
+                }
+                catch( ... )
+                {
+                    error = boost::current_exception( );
+                }
+                lock.lock( );
+
+                if( error && !m_error )
+                    m_error = error;
+                m_active--;
+                if( m_tasks.empty( ) && m_active == 0 )
+                    m_done.notify_all( );
+            }
+        }
+
+        boost::thread_group m_threads;
+        boost::mutex m_mutex;
+        boost::condition_variable m_cond;   /// Signals new tasks and stop
+        boost::condition_variable m_done;   /// Signals that all tasks have finished
+        std::deque< boost::function<void()> > m_tasks;
+        size_t m_active;        /// Number of tasks being executed
+        bool m_stop;
+        boost::exception_ptr m_error;   /// First exception thrown by a task since the last wait()
+    };
+
+    //===================================================================================================
+    //===================================================================================================
+
     Reader::Reader( )
     {
         m_record_nocache = NULL;
         m_cache_enabled = true;
+        m_records_ready = false;
         m_events = NULL;
+        m_event_view = NULL;
+        m_record_stats = NULL;
+        m_filename = "";
+        m_source = NULL;
+        m_owns_source = false;
+        m_mapped_records = NULL;
+        m_record_length = 0;
+        m_buffer_first = 0;
+        m_buffer_num = 0;
+        m_cache_max_records = 0;
+        m_cache_max_bytes = 0;
+        m_projection_enabled = false;
+        m_num_threads = 1;
+        m_prefetcher = NULL;
+        m_prefetch_depth = 0;
+        m_prefetch_hits = 0;
+        m_workers = NULL;
+        resetCacheStatistics( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    Reader::~Reader( )
+    {
+        if( m_prefetcher ) delete m_prefetcher;
+        if( m_workers ) delete m_workers;
+        resetCache( );
+        releaseSource( );
+        if( m_record_nocache ) delete m_record_nocache;
+        if( m_events ) delete m_events;
+        if( m_event_view ) delete m_event_view;
+        if( m_record_stats ) delete m_record_stats;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::open( std::string filename, const int flags )
+    {
+        assert( m_source == NULL );
+        DataSource *source;
+        if( ( flags & reader_mmap ) && !( flags & reader_header_only ) )
+            source = new MappedSource( filename );
+        else
+            source = new FileSource( filename );
+        m_filename = filename;
+        openSource( source, true, flags );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::open( const DataSource &source, const int flags )
+    {
+        assert( m_source == NULL );
         m_filename = "";
+        openSource( &source, false, flags );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::openSource( const DataSource *source, bool owns_source, const int flags )
+    {
+        m_source = source;
+        m_owns_source = owns_source;
+
+        if( m_record_nocache ) delete m_record_nocache;
+        m_record_nocache = NULL;
+
+        if( m_events ) delete m_events;
+        m_events = NULL;
+        if( m_event_view ) delete m_event_view;
+        m_event_view = NULL;
+        if( m_record_stats ) delete m_record_stats;
+        m_record_stats = NULL;
+
+        try
+        {
+            SourceStreamBuf buf( *m_source );
+            std::istream in( &buf );
+            in >> m_header;
+        }
+        catch( ... )
+        {
+            releaseSource( );
+            throw;
+        }
+        initSampleRates( m_header );
+
+        // determine record length
+        m_record_length = 0;
+        m_channel_offset.resize( m_header.getMainHeader_readonly().get_num_signals() );
+        for( size_t i=0; i<m_header.getMainHeader_readonly().get_num_signals(); i++ )
+        {
+            m_channel_offset[i] = m_record_length;
+            size_t samplesize = datatype_size( m_header.getSignalHeader_readonly( i ).get_datatype( ) );
+            m_record_length += samplesize * m_header.getSignalHeader_readonly( i ).get_samples_per_record( );
+        }
+
+        m_record_offset = m_header.getMainHeader_readonly().get_header_length( ) * 256;
+        m_event_offset = boost::numeric_cast<size_t>( m_record_offset + m_header.getMainHeader_readonly().get_num_datarecords() * m_record_length );
+        m_buffer_num = 0;
+
+        if( flags & reader_header_only )
+        {
+            m_records_ready = false;
+            releaseCache( );
+            restartPrefetcher( );
+            return;
+        }
+
+        // sources in memory are decoded in place
+        if( m_source->data( ) != NULL )
+        {
+            if( m_source->size( ) < m_event_offset )
+            {
+                releaseSource( );
+                throw exception::invalid_operation( "file is too short to map all data records" );
+            }
+            m_mapped_records = m_source->data( ) + m_record_offset;
+        }
+
+        initRecordAccess( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::peekHeader( const std::string &filename, GDFHeaderAccess &header )
+    {
+        std::ifstream file( filename.c_str(), std::ios_base::in | std::ios::binary );
+        if( file.fail() )
+            throw exception::file_exists_not( filename );
+        file >> header;
+        initSampleRates( header );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::initSampleRates( GDFHeaderAccess &header )
+    {
+        for( size_t i=0; i<header.getMainHeader_readonly().get_num_signals(); i++ )
+        {
+#ifdef ALLOW_GDF_V_251
+            double fs = header.getSignalHeader( i ).get_samples_per_record( );
+#else
+            double fs = header.getSignalHeader( i ).get_samples_per_record( ) * header.getMainHeader_readonly().get_datarecord_duration(1) / header.getMainHeader_readonly().get_datarecord_duration(0);
+#endif
+            header.getSignalHeader( i ).set_samplerate( boost::numeric_cast<uint32>(fs) );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::initRecordAccess( )
+    {
+        m_records_ready = true;
+        initCache( );
+        restartPrefetcher( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::close( )
+    {
+        if( m_prefetcher ) delete m_prefetcher;
+        m_prefetcher = NULL;
+        if( m_workers ) delete m_workers;
+        m_workers = NULL;
+        if( m_event_view ) delete m_event_view;
+        m_event_view = NULL;
+        if( m_record_stats ) delete m_record_stats;
+        m_record_stats = NULL;
+        releaseSource( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::releaseSource( )
+    {
+        if( m_owns_source && m_source ) delete m_source;
+        m_source = NULL;
+        m_owns_source = false;
+        m_mapped_records = NULL;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::enableCache( bool b )
+    {
+        m_cache_enabled = b;
+        resetCache( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::setMaxCacheRecords( size_t num )
+    {
+        m_cache_max_records = num;
+        shrinkCache( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::setMaxCacheBytes( size_t bytes )
+    {
+        m_cache_max_bytes = bytes;
+        shrinkCache( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::resetCacheStatistics( )
+    {
+        m_cache_hits = 0;
+        m_cache_misses = 0;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::setNumThreads( size_t num )
+    {
+        if( num == 0 )
+            num = std::max( boost::thread::hardware_concurrency( ), 1u );
+        if( m_workers && num != m_num_threads )
+        {
+            delete m_workers;
+            m_workers = NULL;
+        }
+        m_num_threads = num;
+        if( m_num_threads > 1 && m_workers == NULL )
+            m_workers = new WorkerPool( m_num_threads );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::enablePrefetch( size_t depth )
+    {
+        m_prefetch_depth = depth;
+        restartPrefetcher( );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::restartPrefetcher( )
+    {
+        if( m_prefetcher ) delete m_prefetcher;
+        m_prefetcher = NULL;
+        if( m_prefetch_depth > 0 && m_records_ready && m_source != NULL && !isMemoryMapped( ) )
+        {
+            size_t num_records = boost::numeric_cast<size_t>( m_header.getMainHeader_readonly().get_num_datarecords() );
+            m_prefetcher = new Prefetcher( *m_source, &m_header, m_record_offset, m_record_length, num_records, m_prefetch_depth );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    Record *Reader::takePrefetched( size_t index )
+    {
+        if( m_prefetcher == NULL )
+            return NULL;
+        Record *r = m_prefetcher->take( index );
+        if( r )
+            m_prefetch_hits++;
+        return r;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::initCache( )
+    {
+        resetCache( );
+        m_record_cache.clear( );
+        m_cache_referenced.clear( );
+        size_t num_records = boost::numeric_cast<size_t>( m_header.getMainHeader_readonly().get_num_datarecords() );
+        m_record_cache.resize( num_records, NULL );
+        m_cache_referenced.resize( num_records, false );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::resetCache( )
+    {
+        for( std::list<size_t>::iterator it = m_cache_entries.begin(); it != m_cache_entries.end(); it++ )
+        {
+            delete m_record_cache[*it];
+            m_record_cache[*it] = NULL;
+            m_cache_referenced[*it] = false;
+        }
+        m_cache_entries.clear( );
+
+        if( m_record_nocache ) delete m_record_nocache;
+        m_record_nocache = m_records_ready ? new Record( &m_header ) : NULL;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::releaseCache( )
+    {
+        resetCache( );
+        std::vector< Record* >( ).swap( m_record_cache );
+        std::vector<bool>( ).swap( m_cache_referenced );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t Reader::findRecord( uint16 channel_idx, size_t sample_idx )
+    {
+        return boost::numeric_cast<size_t>( floor( ((double)sample_idx) / ((double)m_header.getSignalHeader_readonly( channel_idx ).get_samples_per_record( )) ) );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t Reader::getBlockRecords( size_t record_length )
+    {
+        return std::max( RECORD_BLOCK_SIZE / std::max( record_length, size_t(1) ), size_t(1) );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::getSignals( std::vector< std::vector<double> > &buffer, double start_time, double end_time, std::vector<uint16> signal_indices )
+    {
+        std::vector<size_t> start, end;
+        computeSignalRanges( start_time, end_time, signal_indices, start, end );
+
+        buffer.resize( signal_indices.size() );
+        if( signal_indices.empty( ) )
+            return;
+
+        std::vector<double*> out( signal_indices.size() );
+        for( size_t i=0; i<signal_indices.size(); i++ )
+        {
+            buffer[i].resize( end[i] - start[i] );
+            out[i] = buffer[i].empty( ) ? NULL : &buffer[i][0];
+        }
+        readSignals<double,false>( signal_indices, start, end, &out[0], 1 );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::getSignals( float32 *buffer, size_t channel_stride, size_t sample_stride, double start_time, double end_time, std::vector<uint16> signal_indices )
+    {
+        getSignalsStrided( buffer, channel_stride, sample_stride, start_time, end_time, signal_indices );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::getSignals( float64 *buffer, size_t channel_stride, size_t sample_stride, double start_time, double end_time, std::vector<uint16> signal_indices )
+    {
+        getSignalsStrided( buffer, channel_stride, sample_stride, start_time, end_time, signal_indices );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    template<typename U>
+    void Reader::getSignalsStrided( U *buffer, size_t channel_stride, size_t sample_stride, double start_time, double end_time, std::vector<uint16> signal_indices )
+    {
+        std::vector<size_t> start, end;
+        computeSignalRanges( start_time, end_time, signal_indices, start, end );
+        if( signal_indices.empty( ) )
+            return;
+
+        std::vector<U*> out( signal_indices.size() );
+        for( size_t i=0; i<signal_indices.size(); i++ )
+            out[i] = buffer + i * channel_stride;
+        readSignals<U,false>( signal_indices, start, end, &out[0], sample_stride );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    ChunkCursor Reader::scan( const std::vector<uint16> &signal_indices, size_t chunk_samples, size_t hop )
+    {
+        return ChunkCursor( this, signal_indices, chunk_samples, hop );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::readWindow( const std::vector<uint16> &signal_indices, size_t start, size_t end, double *const *out )
+    {
+        if( end <= start )
+            return;
+        readSignals<double,false>( signal_indices, std::vector<size_t>( signal_indices.size( ), start ),
+                                   std::vector<size_t>( signal_indices.size( ), end ), out, 1, false );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::readWindow( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end, double *const *out )
+    {
+        readSignals<double,false>( signal_indices, start, end, out, 1, false );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::readRecordBlocks( RecordBlockHandler &handler )
+    {
+        size_t ns = m_header.getMainHeader_readonly( ).get_num_signals( );
+        size_t num_records = boost::numeric_cast<size_t>( m_header.getMainHeader_readonly( ).get_num_datarecords( ) );
+        std::vector<uint16> signal_indices( ns );
+        std::vector<size_t> spr( ns );
+        size_t samples_per_record = 0;
+        for( size_t i=0; i<ns; i++ )
+        {
+            signal_indices[i] = boost::numeric_cast<uint16>( i );
+            spr[i] = m_header.getSignalHeader_readonly( i ).get_samples_per_record( );
+            samples_per_record += spr[i];
+        }
+
+        size_t block_records = std::max( RECORD_BLOCK_SAMPLES / std::max( samples_per_record, size_t(1) ), size_t(1) );
+        std::vector< std::vector<double> > buffers( ns );
+        std::vector<double*> out( ns );
+        std::vector<size_t> start( ns ), end( ns );
+        for( size_t first=0; first<num_records; first+=block_records )
+        {
+            size_t last = std::min( first + block_records, num_records );
+            for( size_t i=0; i<ns; i++ )
+            {
+                start[i] = first * spr[i];
+                end[i] = last * spr[i];
+                buffers[i].resize( end[i] - start[i] );
+                out[i] = buffers[i].empty( ) ? NULL : &buffers[i][0];
+            }
+            readWindow( signal_indices, start, end, &out[0] );
+            handler.processBlock( first, last - first, out );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t Reader::getEpochs( std::vector<double> &buffer, uint16 event_type, double pre_time, double post_time, std::vector<uint16> signal_indices )
+    {
+        EventHeader *eh = getEventHeader( );
+        EventRange events = eh->getEvents( event_type );
+        std::vector<uint32> positions;
+        positions.reserve( events.size( ) );
+        for( const uint32 *it = events.begin( ); it != events.end( ); it++ )
+        {
+            if( eh->getMode( ) == 1 )
+                positions.push_back( eh->getMode1Events_readonly( )[*it].position );
+            else
+                positions.push_back( eh->getMode3Events_readonly( )[*it].position );
+        }
+        return getEpochs( buffer, positions, pre_time, post_time, signal_indices );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t Reader::getEpochs( std::vector<double> &buffer, const std::vector<uint32> &positions, double pre_time, double post_time, std::vector<uint16> signal_indices )
+    {
+        prepareRecordAccess( );
+        std::vector<size_t> dummy_start, dummy_end;
+        computeSignalRanges( 0, -1, signal_indices, dummy_start, dummy_end );
+        buffer.clear( );
+        if( signal_indices.empty( ) || positions.empty( ) )
+            return 0;
+
+        const SignalHeader &sh0 = m_header.getSignalHeader_readonly( signal_indices[0] );
+        for( size_t i=1; i<signal_indices.size(); i++ )
+            if( m_header.getSignalHeader_readonly( signal_indices[i] ).get_samples_per_record( ) != sh0.get_samples_per_record( ) )
+                throw exception::invalid_operation( "getEpochs: all channels must have the same sampling rate." );
+
+        const double fs = sh0.get_samplerate( );
+        const size_t spr = sh0.get_samples_per_record( );
+        const int64 total = boost::numeric_cast<int64>( getNumSamples( signal_indices[0] ) );
+        const int64 pre = boost::numeric_cast<int64>( floor( pre_time * fs + 0.5 ) );
+        const int64 num_samples = pre + boost::numeric_cast<int64>( floor( post_time * fs + 0.5 ) );
+        if( num_samples <= 0 )
+            return 0;
+        const size_t S = boost::numeric_cast<size_t>( num_samples );
+        const size_t C = signal_indices.size( );
+
+        buffer.assign( positions.size( ) * C * S, std::numeric_limits<double>::quiet_NaN( ) );
+
+        // epoch start samples, sorted; all epochs have the same length so their ends are sorted too.
+        // Only the event sampling rate is needed, which the view takes from the event table header without
+        // loading the events.
+        const double efs = getEventTableView( ).getSamplingRate( );
+        std::vector< std::pair<int64,size_t> > epochs( positions.size( ) );
+        for( size_t e=0; e<positions.size(); e++ )
+            epochs[e] = std::make_pair( boost::numeric_cast<int64>( floor( EventHeader::posToSec( positions[e], efs ) * fs + 0.5 ) ) - pre, e );
+        std::sort( epochs.begin( ), epochs.end( ) );
+
+        // runs of consecutive records touched by any epoch
+        std::vector< std::pair<size_t,size_t> > runs;
+        for( size_t k=0; k<epochs.size(); k++ )
+        {
+            int64 lo = std::max( epochs[k].first, int64(0) );
+            int64 hi = std::min( epochs[k].first + num_samples, total );
+            if( lo >= hi )
+                continue;
+            size_t first = boost::numeric_cast<size_t>( lo ) / spr;
+            size_t last = boost::numeric_cast<size_t>( hi - 1 ) / spr + 1;
+            if( !runs.empty( ) && first <= runs.back( ).second )
+                runs.back( ).second = std::max( runs.back( ).second, last );
+            else
+                runs.push_back( std::make_pair( first, last ) );
+        }
+
+        std::vector< std::pair<size_t,size_t> > ranges;
+        bool projected = useProjection( );
+        if( projected )
+            computeProjection( signal_indices, ranges );
+
+        // read all records of the epochs at once if they fit into the cache
+        if( !projected && m_cache_enabled && !isMemoryMapped( ) )
+        {
+            std::vector<size_t> records;
+            for( size_t run=0; run<runs.size(); run++ )
+                for( size_t record=runs[run].first; record<runs[run].second; record++ )
+                    records.push_back( record );
+            size_t capacity = getCacheCapacity( );
+            if( capacity == 0 || records.size( ) <= capacity )
+                precacheRecords( records );
+        }
+
+        std::vector<double> scratch( C * spr );
+        size_t first_epoch = 0;
+        for( size_t run=0; run<runs.size(); run++ )
+        {
+            for( size_t record=runs[run].first; record<runs[run].second; record++ )
+            {
+                // decode each record once
+                if( projected && m_record_cache[record] == NULL )
+                {
+                    const char *raw = readProjectedRecord( record, ranges );
+                    for( size_t i=0; i<C; i++ )
+                        deblitRawSamples<double,false>( signal_indices[i], raw, &scratch[i*spr], 0, spr );
+                }
+                else if( m_cache_enabled && !isMemoryMapped( ) )
+                {
+                    Record *r = getRecordPtr( record );
+                    for( size_t i=0; i<C; i++ )
+                        r->getChannel( signal_indices[i] )->deblitSamplesPhys( &scratch[i*spr], 0, spr );
+                }
+                else
+                {
+                    const char *raw = getRawRecord( record, runs[run].second );
+                    for( size_t i=0; i<C; i++ )
+                        deblitRawSamples<double,false>( signal_indices[i], raw, &scratch[i*spr], 0, spr );
+                }
+
+                // copy the record's samples to all epochs that overlap it
+                const int64 rec_lo = boost::numeric_cast<int64>( record * spr );
+                const int64 rec_hi = rec_lo + boost::numeric_cast<int64>( spr );
+                while( first_epoch < epochs.size( ) && epochs[first_epoch].first + num_samples <= rec_lo )
+                    first_epoch++;
+                for( size_t k=first_epoch; k<epochs.size() && epochs[k].first < rec_hi; k++ )
+                {
+                    int64 lo = std::max( rec_lo, epochs[k].first );
+                    int64 hi = std::min( rec_hi, epochs[k].first + num_samples );
+                    if( lo >= hi )
+                        continue;
+                    for( size_t i=0; i<C; i++ )
+                        memcpy( &buffer[( epochs[k].second * C + i ) * S + ( lo - epochs[k].first )],
+                                &scratch[i*spr + ( lo - rec_lo )], ( hi - lo ) * sizeof(double) );
+                }
+            }
+        }
+        return S;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t Reader::getNumSamples( uint16 channel_idx, double start_time, double end_time ) const
+    {
+        std::vector<uint16> signal_indices( 1, channel_idx );
+        std::vector<size_t> start, end;
+        computeSignalRanges( m_header, start_time, end_time, signal_indices, start, end );
+        return end[0] - start[0];
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::computeSignalRanges( const GDFHeaderAccess &header, double start_time, double end_time, std::vector<uint16> &signal_indices,
+                                      std::vector<size_t> &start, std::vector<size_t> &end )
+    {
+        if( signal_indices.size() == 0 )
+        {
+            signal_indices.resize( header.getMainHeader_readonly().get_num_signals() );
+            for( size_t i=0; i<header.getMainHeader_readonly().get_num_signals(); i++ )
+                signal_indices[i] = i;
+        }
+
+        start.resize( signal_indices.size() );
+        end.resize( signal_indices.size() );
+        for( size_t i=0; i<signal_indices.size(); i++ )
+        {
+            const SignalHeader &sh = header.getSignalHeader_readonly( signal_indices[i] );
+            double fs = sh.get_samplerate( );
+            start[i] = boost::numeric_cast<size_t>( floor( start_time * fs ) );
+            end[i] = boost::numeric_cast<size_t>( header.getMainHeader_readonly().get_num_datarecords() * sh.get_samples_per_record() );
+            if( end_time > 0 )
+                end[i] = std::min( end[i], boost::numeric_cast<size_t>( floor( end_time * fs ) ) );
+            end[i] = std::max( end[i], start[i] );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::computeRecordRange( const GDFHeaderAccess &header, const std::vector<uint16> &signal_indices, const std::vector<size_t> &start,
+                                     const std::vector<size_t> &end, size_t &first, size_t &last )
+    {
+        first = std::numeric_limits<size_t>::max( );
+        last = 0;
+        for( size_t i=0; i<signal_indices.size(); i++ )
+        {
+            if( end[i] <= start[i] )
+                continue;
+            size_t spr = header.getSignalHeader_readonly( signal_indices[i] ).get_samples_per_record( );
+            first = std::min( first, start[i] / spr );
+            last = std::max( last, ( end[i] - 1 ) / spr + 1 );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    template<typename T>
+    void Reader::getSignalsRaw( std::vector< std::vector<T> > &buffer, double start_time, double end_time, std::vector<uint16> signal_indices )
+    {
+        std::vector<size_t> start, end;
+        computeSignalRanges( start_time, end_time, signal_indices, start, end );
+        checkDatatype( signal_indices, datatype_id<T>( ) );
+
+        buffer.resize( signal_indices.size() );
+        if( signal_indices.empty( ) )
+            return;
+
+        std::vector<T*> out( signal_indices.size() );
+        for( size_t i=0; i<signal_indices.size(); i++ )
+        {
+            buffer[i].resize( end[i] - start[i] );
+            out[i] = buffer[i].empty( ) ? NULL : &buffer[i][0];
+        }
+        readSignals<T,true>( signal_indices, start, end, &out[0], 1 );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    template<typename T>
+    void Reader::getSignalsRaw( T *buffer, size_t channel_stride, size_t sample_stride, double start_time, double end_time, std::vector<uint16> signal_indices )
+    {
+        std::vector<size_t> start, end;
+        computeSignalRanges( start_time, end_time, signal_indices, start, end );
+        checkDatatype( signal_indices, datatype_id<T>( ) );
+        if( signal_indices.empty( ) )
+            return;
+
+        std::vector<T*> out( signal_indices.size() );
+        for( size_t i=0; i<signal_indices.size(); i++ )
+            out[i] = buffer + i * channel_stride;
+        readSignals<T,true>( signal_indices, start, end, &out[0], sample_stride );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    template<typename T>
+    void Reader::getSignalRaw( uint16 channel_idx, T *buffer, size_t start, size_t end )
+    {
+        const SignalHeader *sh = &m_header.getSignalHeader_readonly( channel_idx );
+
+        if( end <= start )
+            end = boost::numeric_cast<size_t>( sh->get_samples_per_record( ) * m_header.getMainHeader_readonly().get_num_datarecords( ) );
+
+        std::vector<uint16> signal_indices( 1, channel_idx );
+        checkDatatype( signal_indices, datatype_id<T>( ) );
+        readSignals<T,true>( signal_indices, std::vector<size_t>( 1, start ), std::vector<size_t>( 1, end ), &buffer, 1 );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+#define GDF_INSTANTIATE_RAW_READ( T ) \
+    template void Reader::getSignalsRaw<T>( std::vector< std::vector<T> >&, double, double, std::vector<uint16> ); \
+    template void Reader::getSignalsRaw<T>( T*, size_t, size_t, double, double, std::vector<uint16> ); \
+    template void Reader::getSignalRaw<T>( uint16, T*, size_t, size_t );
+
+    GDF_INSTANTIATE_RAW_READ( int8 )
+    GDF_INSTANTIATE_RAW_READ( uint8 )
+    GDF_INSTANTIATE_RAW_READ( int16 )
+    GDF_INSTANTIATE_RAW_READ( uint16 )
+    GDF_INSTANTIATE_RAW_READ( int32 )
+    GDF_INSTANTIATE_RAW_READ( uint32 )
+    GDF_INSTANTIATE_RAW_READ( int64 )
+    GDF_INSTANTIATE_RAW_READ( uint64 )
+    GDF_INSTANTIATE_RAW_READ( float32 )
+    GDF_INSTANTIATE_RAW_READ( float64 )
+
+#undef GDF_INSTANTIATE_RAW_READ
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::checkDatatype( const std::vector<uint16> &signal_indices, uint32 datatype ) const
+    {
+        for( size_t i=0; i<signal_indices.size(); i++ )
+        {
+            uint32 t = m_header.getSignalHeader_readonly( signal_indices[i] ).get_datatype( );
+            if( t != datatype )
+                throw exception::bad_type_assigned_to_channel( "signal " + boost::lexical_cast<std::string>( signal_indices[i] ) + " has type "
+                                                               + boost::lexical_cast<std::string>( t ) + ", requested "
+                                                               + boost::lexical_cast<std::string>( datatype ) );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    /// Copy samples of a channel object to buffer in physical units
+    template<typename U>
+    static void deblitChannelSamples( Channel *c, U *buffer, size_t start, size_t num, size_t stride, boost::false_type )
+    {
+        c->deblitSamplesPhys( buffer, start, num, stride );
+    }
+
+    /// Copy raw samples of a channel object to buffer
+    template<typename U>
+    static void deblitChannelSamples( Channel *c, U *buffer, size_t start, size_t num, size_t stride, boost::true_type )
+    {
+        c->deblitSamplesRaw( buffer, start, num, stride );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    template<typename U, bool RAW>
+    void Reader::readSignals( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end,
+                              U *const *out, size_t stride, bool use_cache )
+    {
+        prepareRecordAccess( );
+        if( m_num_threads > 1 )
+        {
+            readSignalsParallel<U,RAW>( signal_indices, start, end, out, stride );
+            return;
+        }
+
+        size_t record, end_record;
+        computeRecordRange( signal_indices, start, end, record, end_record );
+
+        std::vector< std::pair<size_t,size_t> > ranges;
+        bool projected = useProjection( );
+        if( projected )
+            computeProjection( signal_indices, ranges );
+
+        for( ; record < end_record; record++ )
+        {
+            Record *r = NULL;
+            const char *raw = NULL;
+            if( projected && m_record_cache[record] == NULL )
+                raw = readProjectedRecord( record, ranges );
+            else if( use_cache && m_cache_enabled && !isMemoryMapped( ) )
+                r = getRecordPtr( record );
+            else
+                raw = getRawRecord( record, end_record );
+            for( size_t i=0; i<signal_indices.size(); i++ )
+            {
+                uint16 ch = signal_indices[i];
+                size_t spr = m_header.getSignalHeader_readonly( ch ).get_samples_per_record( );
+                size_t lo = std::max( record * spr, start[i] );
+                size_t hi = std::min( ( record + 1 ) * spr, end[i] );
+                if( lo >= hi )
+                    continue;
+                U *dst = out[i] + ( lo - start[i] ) * stride;
+                if( r )
+                    deblitChannelSamples( r->getChannel( ch ), dst, lo - record * spr, hi - lo, stride, boost::integral_constant<bool,RAW>( ) );
+                else
+                    deblitRawSamples<U,RAW>( ch, raw, dst, lo - record * spr, hi - lo, stride );
+            }
+        }
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    Reader::~Reader( )
+    void Reader::getSignal( uint16 channel_idx, double *buffer, size_t start, size_t end  )
     {
-        resetCache( );
-        if( m_record_nocache ) delete m_record_nocache;
-        if( m_events ) delete m_events;
+        const SignalHeader *sh = &m_header.getSignalHeader_readonly( channel_idx );
+
+        if( end <= start )
+            end = boost::numeric_cast<size_t>( sh->get_samples_per_record( ) * m_header.getMainHeader_readonly().get_num_datarecords( ) );
+
+        readSignals<double,false>( std::vector<uint16>( 1, channel_idx ), std::vector<size_t>( 1, start ), std::vector<size_t>( 1, end ), &buffer, 1 );
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::open( std::string filename )
+    double Reader::getSample( uint16 channel_idx, size_t sample_idx )
     {
-        assert( !m_file.is_open() );
-        m_file.open( filename.c_str(), std::ios_base::in | std::ios::binary );
-        if( m_file.fail() )
-            throw exception::file_exists_not( filename );
+        size_t spr = m_header.getSignalHeader_readonly( channel_idx ).get_samples_per_record( );
+        if( sample_idx >= spr * boost::numeric_cast<size_t>( m_header.getMainHeader_readonly().get_num_datarecords( ) ) )
+            throw exception::index_out_of_range( "sample " + boost::lexical_cast<std::string>( sample_idx ) );
+        if( isMemoryMapped( ) )
+        {
+            double value;
+            size_t record = findRecord( channel_idx, sample_idx );
+            deblitRawSamples<double,false>( channel_idx, getRawRecord( record, record+1 ), &value, sample_idx % spr, 1 );
+            return value;
+        }
+        Record *r = getRecordPtr( findRecord( channel_idx, sample_idx ) );
+        return r->getChannel( channel_idx )->getSamplePhys( sample_idx % spr );
+    }
 
-        m_filename = filename;
-        if( m_record_nocache ) delete m_record_nocache;
-        m_record_nocache = NULL;
+    //===================================================================================================
+    //===================================================================================================
 
-        if( m_events ) delete m_events;
-        m_events = NULL;
+    Record *Reader::getRecordPtr( size_t index )
+    {
+        prepareRecordAccess( );
+        assert( index < boost::numeric_cast<size_t>(m_header.getMainHeader_readonly().get_num_datarecords()) );
+        if( isMemoryMapped( ) )
+        {
+            m_record_nocache->frombuffer( getRawRecord( index, index+1 ) );
+            return m_record_nocache;
+        }
+        Record *r = m_record_cache[index];
+        if( r == NULL )
+        {
+            m_cache_misses++;
+            Record *pre = takePrefetched( index );
+            if( pre )
+            {
+                // swap the prefetched record in and give the replaced one to the prefetcher
+                if( m_cache_enabled )
+                {
+                    m_prefetcher->recycle( insertCacheEntry( index ) );
+                    m_record_cache[index] = pre;
+                }
+                else
+                {
+                    m_prefetcher->recycle( m_record_nocache );
+                    m_record_nocache = pre;
+                }
+                return pre;
+            }
+            const char *raw = getRawRecord( index, index+1 );
+            if( m_cache_enabled )
+                r = insertCacheEntry( index );
+            else
+                r = m_record_nocache;
+            r->frombuffer( raw );
+        }
+        else
+        {
+            m_cache_hits++;
+            m_cache_referenced[index] = true;
+        }
+        return r;
+    }
 
-        m_file >> m_header;
+    //===================================================================================================
+    //===================================================================================================
 
-        // determine record length
-        m_record_length = 0;
-        for( size_t i=0; i<m_header.getMainHeader_readonly().get_num_signals(); i++ )
+    void Reader::readRecord( size_t index, Record *rec )
+    {
+        prepareRecordAccess( );
+        assert( index < boost::numeric_cast<size_t>(m_header.getMainHeader_readonly().get_num_datarecords()) );
+        if( isMemoryMapped( ) )
         {
-            size_t samplesize = datatype_size( m_header.getSignalHeader_readonly( i ).get_datatype( ) );
-            m_record_length += samplesize * m_header.getSignalHeader_readonly( i ).get_samples_per_record( );
-#ifdef ALLOW_GDF_V_251
-            double fs = m_header.getSignalHeader( i ).get_samples_per_record( );
-#else
-            double fs = m_header.getSignalHeader( i ).get_samples_per_record( ) * m_header.getMainHeader_readonly().get_datarecord_duration(1) / m_header.getMainHeader_readonly().get_datarecord_duration(0);
-#endif
-            m_header.getSignalHeader( i ).set_samplerate( boost::numeric_cast<uint32>(fs) );
+            rec->frombuffer( getRawRecord( index, index+1 ) );
+            return;
+        }
+        Record *r = m_record_cache[index];
+        if( r == NULL )
+        {
+            m_cache_misses++;
+            Record *pre = takePrefetched( index );
+            if( pre )
+            {
+                *rec = *pre;
+                if( m_cache_enabled )
+                {
+                    m_prefetcher->recycle( insertCacheEntry( index ) );
+                    m_record_cache[index] = pre;
+                }
+                else
+                    m_prefetcher->recycle( pre );
+                return;
+            }
+            const char *raw = getRawRecord( index, index+1 );
+            if( m_cache_enabled )
+            {
+                r = insertCacheEntry( index );
+                r->frombuffer( raw );
+            }
+            else
+            {
+                rec->frombuffer( raw ); // read directly
+                return;
+            }
+        }
+        else
+        {
+            m_cache_hits++;
+            m_cache_referenced[index] = true;
         }
+        *rec = *r;  // copy from cache
+    }
 
-        m_record_offset = m_header.getMainHeader_readonly().get_header_length( ) * 256;
-        m_event_offset = boost::numeric_cast<size_t>( m_record_offset + m_header.getMainHeader_readonly().get_num_datarecords() * m_record_length );
+    //===================================================================================================
+    //===================================================================================================
 
-        initCache( );
+    void Reader::precacheRecords( size_t start, size_t end )
+    {
+        prepareRecordAccess( );
+        if( isMemoryMapped( ) || !m_cache_enabled )
+            return;
+        for( size_t i=start; i<end; i++ )
+        {
+            if( m_record_cache[i] != NULL )
+                continue;
+            m_cache_misses++;
+            const char *raw = getRawRecord( i, end );
+            insertCacheEntry( i )->frombuffer( raw );
+        }
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::close( )
+    void Reader::precacheRecords( const std::vector<size_t> &indices )
     {
-        m_file.close( );
+        prepareRecordAccess( );
+        size_t num_records = boost::numeric_cast<size_t>( m_header.getMainHeader_readonly().get_num_datarecords() );
+        for( size_t i=0; i<indices.size(); i++ )
+            if( indices[i] >= num_records )
+                throw exception::index_out_of_range( "record " + boost::lexical_cast<std::string>( indices[i] ) );
+        if( isMemoryMapped( ) || !m_cache_enabled )
+            return;
+
+        std::vector<size_t> missing;
+        for( size_t i=0; i<indices.size(); i++ )
+        {
+            size_t index = indices[i];
+            if( m_record_cache[index] != NULL )
+                continue;
+            Record *pre = m_prefetcher ? m_prefetcher->claim( index ) : NULL;
+            if( pre )
+            {
+                // already read ahead; swap it in like getRecordPtr does
+                m_cache_misses++;
+                m_prefetch_hits++;
+                m_prefetcher->recycle( insertCacheEntry( index ) );
+                m_record_cache[index] = pre;
+            }
+            else
+                missing.push_back( index );
+        }
+        std::sort( missing.begin( ), missing.end( ) );
+        missing.erase( std::unique( missing.begin( ), missing.end( ) ), missing.end( ) );
+
+        size_t batch = getBlockRecords( m_record_length );
+        size_t capacity = getCacheCapacity( );
+        if( capacity > 0 )
+            batch = std::min( batch, capacity );
+
+        std::vector<ReadRequest> requests;
+        for( size_t first=0; first<missing.size(); first+=batch )
+        {
+            size_t last = std::min( first + batch, missing.size( ) );
+            size_t bytes = ( last - first ) * m_record_length;
+            if( m_batch_buffer.size( ) < std::max( bytes, size_t(1) ) )
+                m_batch_buffer.resize( std::max( bytes, size_t(1) ) );
+
+            // one request per run of consecutive records
+            requests.clear( );
+            for( size_t i=first; i<last; i++ )
+            {
+                if( i > first && missing[i] == missing[i-1] + 1 )
+                {
+                    requests.back( ).bytes += m_record_length;
+                    continue;
+                }
+                ReadRequest rq;
+                rq.offset = m_record_offset + static_cast<uint64>( m_record_length ) * missing[i];
+                rq.buffer = &m_batch_buffer[0] + ( i - first ) * m_record_length;
+                rq.bytes = m_record_length;
+                requests.push_back( rq );
+            }
+            m_source->readBatch( requests );
+
+            for( size_t i=first; i<last; i++ )
+            {
+                m_cache_misses++;
+                insertCacheEntry( missing[i] )->frombuffer( &m_batch_buffer[0] + ( i - first ) * m_record_length );
+            }
+        }
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::enableCache( bool b )
+    size_t Reader::getCacheCapacity( ) const
     {
-        m_cache_enabled = b;
-        resetCache( );
+        size_t capacity = m_cache_max_records;
+        if( m_cache_max_bytes > 0 && m_record_length > 0 )
+        {
+            size_t by_bytes = std::max( m_cache_max_bytes / m_record_length, size_t(1) );
+            if( capacity == 0 || by_bytes < capacity )
+                capacity = by_bytes;
+        }
+        return capacity;
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::initCache( )
+    Record *Reader::insertCacheEntry( size_t index )
     {
-        resetCache( );
-        m_record_cache.clear( );
-        size_t num_records = boost::numeric_cast<size_t>( m_header.getMainHeader_readonly().get_num_datarecords() );
-        m_record_cache.resize( num_records, NULL );
+        size_t capacity = getCacheCapacity( );
+        Record *r;
+        if( capacity > 0 && m_cache_entries.size( ) >= capacity )
+            r = evictCacheEntry( );
+        else
+            r = new Record( &m_header );
+        m_record_cache[index] = r;
+        m_cache_referenced[index] = false;
+        m_cache_entries.push_back( index );
+        return r;
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::resetCache( )
+    Record *Reader::evictCacheEntry( )
     {
-        for( std::list<size_t>::iterator it = m_cache_entries.begin(); it != m_cache_entries.end(); it++ )
+        assert( !m_cache_entries.empty( ) );
+        while( true )
         {
-            delete m_record_cache[*it];
-            m_record_cache[*it] = NULL;
+            size_t victim = m_cache_entries.front( );
+            m_cache_entries.pop_front( );
+            if( m_cache_referenced[victim] )
+            {
+                // second chance
+                m_cache_referenced[victim] = false;
+                m_cache_entries.push_back( victim );
+            }
+            else
+            {
+                Record *r = m_record_cache[victim];
+                m_record_cache[victim] = NULL;
+                return r;
+            }
         }
-        m_cache_entries.clear( );
-
-        if( m_record_nocache ) delete m_record_nocache;
-        m_record_nocache = new Record( &m_header );
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    size_t Reader::findRecord( uint16 channel_idx, size_t sample_idx )
+    void Reader::shrinkCache( )
     {
-        return boost::numeric_cast<size_t>( floor( ((double)sample_idx) / ((double)m_header.getSignalHeader_readonly( channel_idx ).get_samples_per_record( )) ) );
+        size_t capacity = getCacheCapacity( );
+        if( capacity == 0 )
+            return;
+        while( m_cache_entries.size( ) > capacity )
+            delete evictCacheEntry( );
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::getSignals( std::vector< std::vector<double> > &buffer, double start_time, double end_time, std::vector<uint16> signal_indices )
+    const char *Reader::getRawRecord( size_t index, size_t end )
     {
-        using boost::numeric_cast;
+        if( isMemoryMapped( ) )
+            return m_mapped_records + m_record_length*index;
 
-        if( signal_indices.size() == 0 )
+        if( index < m_buffer_first || index >= m_buffer_first + m_buffer_num )
         {
-            signal_indices.resize( m_header.getMainHeader_readonly().get_num_signals() );
-            for( size_t i=0; i<m_header.getMainHeader_readonly().get_num_signals(); i++ )
-                signal_indices[i] = i;
+            size_t num_records = boost::numeric_cast<size_t>( m_header.getMainHeader_readonly().get_num_datarecords() );
+            size_t block_records = getBlockRecords( m_record_length );
+            end = std::min( std::max( end, index+1 ), num_records );
+            readRecordBlock( index, std::min( end - index, block_records ) );
         }
+        return &m_record_buffer[0] + ( index - m_buffer_first ) * m_record_length;
+    }
 
-        buffer.resize( signal_indices.size() );
-#ifdef ALLOW_GDF_V_251
-        double record_rate = 1;
-#else
-        double record_rate = m_header.getMainHeader_readonly().get_datarecord_duration(1) / m_header.getMainHeader_readonly().get_datarecord_duration(0);
-#endif
-        size_t record = boost::numeric_cast<size_t>( floor( start_time * record_rate ) );
+    //===================================================================================================
+    //===================================================================================================
 
+    void Reader::readRecordBlock( size_t start, size_t num )
+    {
+        size_t bytes = num * m_record_length;
+        if( m_record_buffer.size( ) < std::max( bytes, size_t(1) ) )
+            m_record_buffer.resize( std::max( bytes, size_t(1) ) );
 
-        std::vector<size_t> start, samples_to_go, readpos, writepos;
+        m_buffer_num = 0;
+        m_source->readAt( m_record_offset + static_cast<uint64>( m_record_length )*start, &m_record_buffer[0], bytes );
+        m_buffer_first = start;
+        m_buffer_num = num;
+    }
 
-        start.resize( signal_indices.size() );
-        samples_to_go.resize( signal_indices.size() );
-        readpos.resize( signal_indices.size() );
-        writepos.resize( signal_indices.size() );
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::computeProjection( const std::vector<uint16> &signal_indices, std::vector< std::pair<size_t,size_t> > &ranges ) const
+    {
+        ranges.clear( );
         for( size_t i=0; i<signal_indices.size(); i++ )
         {
-            SignalHeader *sh = &m_header.getSignalHeader( signal_indices[i] );
-            double fs = sh->get_samplerate( );
-            start[i] = boost::numeric_cast<size_t>( floor( start_time * fs ) );
-            samples_to_go[i] = boost::numeric_cast<size_t>( m_header.getMainHeader_readonly().get_num_datarecords() * sh->get_samples_per_record() );
-            if( end_time > 0 )
-                samples_to_go[i] = std::min( samples_to_go[i], boost::numeric_cast<size_t>( floor( end_time * fs ) ) );
-            samples_to_go[i] -= start[i];
-            buffer[i].resize( boost::numeric_cast<size_t>( samples_to_go[i] ) );
-            readpos[i] = start[i] % sh->get_samples_per_record();
+            const SignalHeader &sh = m_header.getSignalHeader_readonly( signal_indices[i] );
+            size_t len = datatype_size( sh.get_datatype( ) ) * sh.get_samples_per_record( );
+            if( len > 0 )
+                ranges.push_back( std::make_pair( m_channel_offset[signal_indices[i]], m_channel_offset[signal_indices[i]] + len ) );
         }
+        std::sort( ranges.begin( ), ranges.end( ) );
 
-        while( sum(samples_to_go) > 0 )
+        // coalesce adjacent (and duplicate) ranges
+        size_t n = 0;
+        for( size_t i=0; i<ranges.size(); i++ )
         {
-            Record *r = getRecordPtr( record );
-            for( size_t i=0; i<signal_indices.size(); i++ )
-            {
-                SignalHeader *sh = &m_header.getSignalHeader( signal_indices[i] );
-                size_t n = std::min( boost::numeric_cast<size_t>(sh->get_samples_per_record( )) - readpos[i], samples_to_go[i] );
-                r->getChannel( signal_indices[i] )->deblitSamplesPhys( &buffer[i][writepos[i]], readpos[i], n );
-                samples_to_go[i] -= n;
-                writepos[i] += n;
-                readpos[i] = 0;
-            }
-            record++;
+            if( n > 0 && ranges[i].first <= ranges[n-1].second )
+                ranges[n-1].second = std::max( ranges[n-1].second, ranges[i].second );
+            else
+                ranges[n++] = ranges[i];
         }
+        ranges.resize( n );
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::getSignal( uint16 channel_idx, double *buffer, size_t start, size_t end  )
+    const char *Reader::readProjectedRecord( size_t index, const std::vector< std::pair<size_t,size_t> > &ranges )
     {
-        using boost::numeric_cast;
+        if( m_projection_buffer.size( ) < std::max( m_record_length, size_t(1) ) )
+            m_projection_buffer.resize( std::max( m_record_length, size_t(1) ) );
 
-        SignalHeader *sh = &m_header.getSignalHeader( channel_idx );
+        uint64 record_pos = m_record_offset + static_cast<uint64>( m_record_length )*index;
+        for( size_t i=0; i<ranges.size(); i++ )
+            m_source->readAt( record_pos + ranges[i].first, &m_projection_buffer[ranges[i].first], ranges[i].second - ranges[i].first );
+        return &m_projection_buffer[0];
+    }
 
-        if( end <= start )
-            end = boost::numeric_cast<size_t>( sh->get_samples_per_record( ) * m_header.getMainHeader_readonly().get_num_datarecords( ) );
+    //===================================================================================================
+    //===================================================================================================
+
+    template<typename U, bool RAW>
+    void Reader::readSignalsParallel( const std::vector<uint16> &signal_indices, const std::vector<size_t> &start, const std::vector<size_t> &end,
+                                      U *const *out, size_t stride )
+    {
+        size_t record, end_record;
+        computeRecordRange( signal_indices, start, end, record, end_record );
+        if( record >= end_record )
+            return;
 
-        size_t record = boost::numeric_cast<size_t>( floor( ((double)start)/((double)sh->get_samples_per_record()) ) );
-        size_t readpos = start % sh->get_samples_per_record();
-        size_t writepos = 0;
-        size_t samples_to_go = end - start;
+        // the pool is stopped by close( )
+        if( m_workers == NULL )
+            m_workers = new WorkerPool( m_num_threads );
 
-        while( samples_to_go > 0 )
+        if( isMemoryMapped( ) )
         {
-            Record *r = getRecordPtr( record );
+            decodeRecordsParallel<U,RAW>( getRawRecord( record, end_record ), record, end_record, signal_indices, start, end, out, stride );
+            m_workers->wait( );
+            return;
+        }
 
-            size_t n = std::min( (size_t)sh->get_samples_per_record( ) - readpos, samples_to_go );
-            r->getChannel( channel_idx )->deblitSamplesPhys( &buffer[writepos], readpos, n );
-            samples_to_go -= n;
-            writepos += n;
-            readpos = 0;
+        // load the next block on the calling thread while the workers decode the current one
+        size_t block_records = getBlockRecords( m_record_length );
+        std::vector<char> blocks[2];
+        size_t current = 0;
+        while( record < end_record )
+        {
+            size_t num = std::min( end_record - record, block_records );
+            std::vector<char> &block = blocks[current];
+            block.resize( std::max( num * m_record_length, size_t(1) ) );
+            try
+            {
+                m_source->readAt( m_record_offset + static_cast<uint64>( m_record_length ) * record, &block[0], num * m_record_length );
+            }
+            catch( ... )
+            {
+                try { m_workers->wait( ); } catch( ... ) { }
+                throw;
+            }
 
-            record++;
+            // the previous block is decoded before its buffer is loaded again
+            m_workers->wait( );
+            decodeRecordsParallel<U,RAW>( &block[0], record, record + num, signal_indices, start, end, out, stride );
+            record += num;
+            current = 1 - current;
         }
+        m_workers->wait( );
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    double Reader::getSample( uint16 channel_idx, size_t sample_idx )
+    template<typename U, bool RAW>
+    void Reader::decodeRecordsParallel( const char *records, size_t rec_begin, size_t rec_end, const std::vector<uint16> &signal_indices,
+                                        const std::vector<size_t> &start, const std::vector<size_t> &end, U *const *out, size_t stride ) const
     {
-        Record *r = getRecordPtr( findRecord( channel_idx, sample_idx ) );
-        size_t spr = m_header.getSignalHeader_readonly( channel_idx ).get_samples_per_record( );
-        return r->getChannel( channel_idx )->getSamplePhys( sample_idx % spr );
-    }
+        RecordDecodeTask<U> task;
+        task.records = records;
+        task.first_record = rec_begin;
+        task.rec_begin = rec_begin;
+        task.rec_end = rec_end;
+        task.ch_begin = 0;
+        task.ch_end = signal_indices.size( );
+        task.signal_indices = &signal_indices;
+        task.start = &start;
+        task.end = &end;
+        task.out = out;
+        task.stride = stride;
 
-    //===================================================================================================
-    //===================================================================================================
+        size_t samples_per_record = 0;
+        for( size_t i=0; i<signal_indices.size(); i++ )
+            samples_per_record += m_header.getSignalHeader_readonly( signal_indices[i] ).get_samples_per_record( );
 
-    Record *Reader::getRecordPtr( size_t index )
-    {
-        assert( index < boost::numeric_cast<size_t>(m_header.getMainHeader_readonly().get_num_datarecords()) );
-        Record *r = m_record_cache[index];
-        if( r == NULL )
+        size_t num_records = rec_end - rec_begin;
+        bool split_records = num_records >= m_num_threads;
+        size_t num_parts = std::min( m_num_threads, split_records ? num_records : signal_indices.size( ) );
+        num_parts = std::min( num_parts, std::max( num_records * samples_per_record / PARALLEL_MIN_SAMPLES, size_t(1) ) );
+        num_parts = std::max( num_parts, size_t(1) );
+
+        for( size_t t=0; t<num_parts; t++ )
         {
-            size_t pos = m_record_offset + m_record_length*index;
-            m_file.seekg( pos );
-            if( m_cache_enabled )
+            RecordDecodeTask<U> part = task;
+            if( split_records )
             {
-                r = new Record( &m_header );
-                m_file >> *r;
-                m_record_cache[index] = r;
-                m_cache_entries.push_back( index );
+                part.rec_begin = rec_begin + t * num_records / num_parts;
+                part.rec_end = rec_begin + ( t + 1 ) * num_records / num_parts;
             }
             else
             {
-                m_file >> *m_record_nocache;
-                r = m_record_nocache;
+                part.ch_begin = t * signal_indices.size( ) / num_parts;
+                part.ch_end = ( t + 1 ) * signal_indices.size( ) / num_parts;
             }
+            m_workers->submit( boost::bind( &Reader::decodeRecords<U,RAW>, this, part ) );
         }
-        return r;
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::readRecord( size_t index, Record *rec )
+    template<typename U, bool RAW>
+    void Reader::decodeRecords( const RecordDecodeTask<U> &task ) const
     {
-        assert( index < boost::numeric_cast<size_t>(m_header.getMainHeader_readonly().get_num_datarecords()) );
-        Record *r = m_record_cache[index];
-        if( r == NULL )
+        for( size_t rec=task.rec_begin; rec<task.rec_end; rec++ )
         {
-            size_t pos = m_record_offset + m_record_length*index;
-            m_file.seekg( pos );
-            if( m_cache_enabled )
-            {
-                r = new Record( &m_header );
-                m_file >> *r;
-                m_record_cache[index] = r;
-                m_cache_entries.push_back( index );
-            }
-            else
+            const char *raw = task.records + ( rec - task.first_record ) * m_record_length;
+            for( size_t i=task.ch_begin; i<task.ch_end; i++ )
             {
-                m_file >> *rec; // read directly
-                return;
+                uint16 ch = (*task.signal_indices)[i];
+                size_t spr = m_header.getSignalHeader_readonly( ch ).get_samples_per_record( );
+                size_t lo = std::max( rec * spr, (*task.start)[i] );
+                size_t hi = std::min( ( rec + 1 ) * spr, (*task.end)[i] );
+                if( lo < hi )
+                    deblitRawSamples<U,RAW>( ch, raw, task.out[i] + ( lo - (*task.start)[i] ) * task.stride, lo - rec * spr, hi - lo, task.stride );
             }
         }
-        *rec = *r;  // copy from cache
     }
 
     //===================================================================================================
     //===================================================================================================
 
-    void Reader::precacheRecords( size_t start, size_t end )
+    /// Convert samples in file representation to physical units
+    template<typename U>
+    static void decodeSamples( const SignalHeader *sh, const char *in, U *buffer, size_t num, size_t stride, boost::false_type )
     {
-        for( size_t i=start; i<end; i++ )
-            getRecordPtr( i );
+        convertRawToPhys( sh->get_datatype( ), in, buffer, num, sh->getRawToPhysScale( ), sh->getRawToPhysOffset( ), stride );
+    }
+
+    /// Copy raw samples in file representation; the data type has been checked by the caller
+    template<typename U>
+    static void decodeSamples( const SignalHeader *, const char *in, U *buffer, size_t num, size_t stride, boost::true_type )
+    {
+        copyRawSamples( in, buffer, num, stride );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    template<typename U, bool RAW>
+    void Reader::deblitRawSamples( uint16 channel_idx, const char *record, U *buffer, size_t start, size_t num, size_t stride ) const
+    {
+        const SignalHeader *sh = &m_header.getSignalHeader_readonly( channel_idx );
+        const char *in = record + m_channel_offset[channel_idx] + start * datatype_size( sh->get_datatype( ) );
+
+        decodeSamples( sh, in, buffer, num, stride, boost::integral_constant<bool,RAW>( ) );
     }
 
     //===================================================================================================
@@ -302,10 +1607,9 @@ namespace gdf
     {
         if( m_events == NULL )
         {
-            if( m_file.is_open() )
+            if( m_source != NULL )
             {
                 m_events = new EventHeader( );
-                m_file.seekg( m_event_offset );
                 readEvents( );
             }
             else
@@ -314,6 +1618,52 @@ namespace gdf
         return m_events;
     }
 
+    //===================================================================================================
+    //===================================================================================================
+
+    const EventTableView &Reader::getEventTableView( )
+    {
+        if( m_event_view == NULL )
+        {
+            if( m_source == NULL )
+                throw exception::file_not_open( "when attempting to map events" );
+            if( m_source->data( ) == NULL && !m_filename.empty( ) )
+                m_event_view = new EventTableView( m_filename, m_event_offset );
+            else
+                m_event_view = new EventTableView( *m_source, m_event_offset );
+        }
+        return *m_event_view;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    const RecordStatsIndex &Reader::getRecordStats( )
+    {
+        if( m_record_stats == NULL )
+        {
+            if( m_source == NULL )
+                throw exception::file_not_open( "when attempting to load record statistics" );
+            if( m_filename.empty( ) )
+                throw exception::invalid_operation( "record statistics are only available for files opened by name" );
+            RecordStatsIndex *index = new RecordStatsIndex( );
+            try
+            {
+                std::string sidecar = RecordStatsIndex::getSidecarName( m_filename );
+                index->load( sidecar );
+                if( !index->matches( m_header ) )
+                    throw exception::serialization_error( sidecar + " does not match " + m_filename );
+            }
+            catch( ... )
+            {
+                delete index;
+                throw;
+            }
+            m_record_stats = index;
+        }
+        return *m_record_stats;
+    }
+
 	//===================================================================================================
 	//===================================================================================================
 
@@ -358,8 +1708,77 @@ namespace gdf
 	//===================================================================================================
 	//===================================================================================================
 
+    void Reader::getSparseSignal( uint16 channel_idx, std::vector<double> &times, std::vector<double> &values )
+    {
+        const SignalHeader &sh = getSignalHeader_readonly( channel_idx );
+        if( sh.get_samples_per_record( ) != 0 )
+            throw exception::event_conversion_error( "getSparseSignal: channel " + boost::lexical_cast<std::string>( channel_idx ) + " is not a NEQS channel." );
+        uint32 datatype = sh.get_datatype( );
+        if( datatype > UINT32 && datatype != FLOAT32 )
+            throw exception::event_conversion_error( "Invalid data type for NEQS sample; event not converted to sample." );
+
+        times.clear( );
+        values.clear( );
+        EventHeader *eh = getEventHeader( );
+        if( eh->getMode( ) != 3 )
+            return;
+
+        // gather the columns of the channel's events, then convert them in tight loops
+        EventRange range = eh->getSparseSampleRange( boost::numeric_cast<uint16>( channel_idx + 1 ) );
+        const std::vector<Mode3Event> &events = eh->getMode3Events_readonly( );
+        size_t n = range.size( );
+        times.resize( n );
+        values.resize( n );
+        if( n == 0 )
+            return;
+
+        const double efs = eh->getSamplingRate( );
+        for( size_t i=0; i<n; i++ )
+            times[i] = EventHeader::posToSec( events[range[i]].position, efs );
+
+        if( datatype == FLOAT32 )
+        {
+            std::vector<float32> raw( n );
+            for( size_t i=0; i<n; i++ )
+                raw[i] = events[range[i]].value;
+            convertRawToPhys( &raw[0], &values[0], n, sh.getRawToPhysScale( ), sh.getRawToPhysOffset( ) );
+        }
+        else
+        {
+            std::vector<uint32> raw( n );
+            for( size_t i=0; i<n; i++ )
+                raw[i] = events[range[i]].duration;
+            convertRawToPhys( &raw[0], &values[0], n, sh.getRawToPhysScale( ), sh.getRawToPhysOffset( ) );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Reader::getSparseSignals( std::vector< std::vector<double> > &times, std::vector< std::vector<double> > &values )
+    {
+        size_t ns = m_header.getMainHeader_readonly( ).get_num_signals( );
+        times.resize( ns );
+        values.resize( ns );
+        for( size_t i=0; i<ns; i++ )
+        {
+            if( m_header.getSignalHeader_readonly( i ).get_samples_per_record( ) == 0 )
+                getSparseSignal( boost::numeric_cast<uint16>( i ), times[i], values[i] );
+            else
+            {
+                times[i].clear( );
+                values[i].clear( );
+            }
+        }
+    }
+
+	//===================================================================================================
+	//===================================================================================================
+
     void Reader::readEvents( )
     {
-        m_events->fromStream( m_file );
+        SourceStreamBuf buf( *m_source, m_event_offset );
+        std::istream in( &buf );
+        m_events->fromStream( in );
     }
 }
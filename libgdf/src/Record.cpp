@@ -144,6 +144,19 @@ namespace gdf
     //===================================================================================================
     //===================================================================================================
 
+    void Record::frombuffer( const char *in )
+    {
+        size_t M = channels.size();
+        for( size_t i=0; i<M; i++ )
+        {
+            channels[i]->frombuffer( in );
+            in += datatype_size( channels[i]->getTypeID( ) ) * ( channels[i]->getFree( ) + channels[i]->getWritten( ) );
+        }
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
     std::ostream &operator<<( std::ostream &out, const Record &r )
     {
         size_t M = r.channels.size();
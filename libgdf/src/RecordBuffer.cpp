@@ -28,6 +28,7 @@ namespace gdf
     RecordBuffer::RecordBuffer( const GDFHeaderAccess *gdfh ) : m_gdfh(gdfh)
     {
         m_pool = NULL;
+        m_saturate = false;
     }
 
     //===================================================================================================
@@ -143,7 +144,7 @@ namespace gdf
     void RecordBuffer::addSamplePhys( const size_t channel_idx, const double value )
     {
         Channel *ch = getValidChannel( channel_idx );
-        ch->addSamplePhys( value );
+        ch->addSamplePhys( value, m_saturate );
         if( ch->getFree( ) == 0 )
             handleChannelFull( channel_idx );
     }
@@ -158,7 +159,7 @@ namespace gdf
         {
             Channel *ch = getValidChannel( channel_idx );
             size_t n = std::min( num-i, ch->getFree( ) );
-            ch->blitSamplesPhys( &values[i], n );
+            ch->blitSamplesPhys( &values[i], n, m_saturate );
             if( ch->getFree( ) == 0 )
                 handleChannelFull( channel_idx );
             i += n;
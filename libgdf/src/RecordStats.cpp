@@ -0,0 +1,313 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "GDF/RecordStats.h"
+#include "GDF/GDFHeaderAccess.h"
+#include "GDF/Reader.h"
+#include "GDF/Record.h"
+#include <boost/lexical_cast.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+namespace gdf
+{
+    static const char RECORDSTATS_MAGIC[8] = { 'G', 'D', 'F', 'R', 'S', 'I', '0', '1' };
+
+    /// Size of a RecordStat in the sidecar file
+    static const size_t RECORDSTATS_ENTRY_SIZE = 4*sizeof(float32) + sizeof(uint32);
+
+    //===================================================================================================
+    //===================================================================================================
+
+    RecordStatsIndex::RecordStatsIndex( ) : m_num_records( 0 )
+    {
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    RecordStatsIndex::~RecordStatsIndex( )
+    {
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    RecordStat RecordStatsIndex::computeStat( const double *samples, size_t num )
+    {
+        double mn = std::numeric_limits<double>::infinity( );
+        double mx = -std::numeric_limits<double>::infinity( );
+        double sum = 0, sumsq = 0;
+        uint32 nans = 0;
+        for( size_t i=0; i<num; i++ )
+        {
+            double x = samples[i];
+            if( x != x )
+            {
+                nans++;
+                continue;
+            }
+            mn = std::min( mn, x );
+            mx = std::max( mx, x );
+            sum += x;
+            sumsq += x * x;
+        }
+
+        RecordStat s;
+        s.nan_count = nans;
+        size_t n = num - nans;
+        if( n == 0 )
+        {
+            s.min = s.max = s.mean = s.rms = std::numeric_limits<float32>::quiet_NaN( );
+            return s;
+        }
+        s.min = static_cast<float32>( mn );
+        s.max = static_cast<float32>( mx );
+        s.mean = static_cast<float32>( sum / n );
+        s.rms = static_cast<float32>( sqrt( sumsq / n ) );
+        return s;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void RecordStatsIndex::reset( const GDFHeaderAccess &header )
+    {
+        size_t ns = header.getMainHeader_readonly( ).get_num_signals( );
+        m_spr.resize( ns );
+        size_t max_spr = 0;
+        for( size_t i=0; i<ns; i++ )
+        {
+            m_spr[i] = header.getSignalHeader_readonly( i ).get_samples_per_record( );
+            max_spr = std::max( max_spr, m_spr[i] );
+        }
+        m_scratch.resize( max_spr );
+        m_stats.clear( );
+        m_num_records = 0;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void RecordStatsIndex::addRecord( Record *rec )
+    {
+        for( size_t i=0; i<m_spr.size(); i++ )
+        {
+            if( m_spr[i] > 0 )
+                rec->getChannel( i )->deblitSamplesPhys( &m_scratch[0], 0, m_spr[i] );
+            m_stats.push_back( computeStat( m_scratch.empty( ) ? NULL : &m_scratch[0], m_spr[i] ) );
+        }
+        m_num_records++;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void RecordStatsIndex::build( Reader &reader )
+    {
+        reset( reader.getHeaderAccess_readonly( ) );
+        m_stats.reserve( boost::numeric_cast<size_t>( reader.getMainHeader_readonly( ).get_num_datarecords( ) ) * m_spr.size( ) );
+        reader.readRecordBlocks( *this );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void RecordStatsIndex::processBlock( size_t /*first_record*/, size_t num_records, const std::vector<double*> &channels )
+    {
+        for( size_t r=0; r<num_records; r++ )
+            for( size_t i=0; i<m_spr.size(); i++ )
+                m_stats.push_back( computeStat( channels[i] + r * m_spr[i], m_spr[i] ) );
+        m_num_records += num_records;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void RecordStatsIndex::save( const std::string &filename ) const
+    {
+        std::ofstream file( filename.c_str( ), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+        if( file.fail( ) )
+            throw exception::serialization_error( "can not write record statistics file " + filename );
+
+        // header: magic, number of channels, number of records, samples per record of each channel
+        file.write( RECORDSTATS_MAGIC, sizeof(RECORDSTATS_MAGIC) );
+        writeLittleEndian( file, boost::numeric_cast<uint32>( m_spr.size( ) ) );
+        writeLittleEndian( file, uint64( m_num_records ) );
+        for( size_t i=0; i<m_spr.size(); i++ )
+            writeLittleEndian( file, boost::numeric_cast<uint32>( m_spr[i] ) );
+
+        for( size_t n=0; n<m_stats.size(); n++ )
+        {
+            writeLittleEndian( file, m_stats[n].min );
+            writeLittleEndian( file, m_stats[n].max );
+            writeLittleEndian( file, m_stats[n].mean );
+            writeLittleEndian( file, m_stats[n].rms );
+            writeLittleEndian( file, m_stats[n].nan_count );
+        }
+
+        if( file.fail( ) )
+            throw exception::serialization_error( "can not write record statistics file " + filename );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void RecordStatsIndex::load( const std::string &filename )
+    {
+        std::ifstream file( filename.c_str( ), std::ios_base::in | std::ios_base::binary );
+        if( file.fail( ) )
+            throw exception::file_exists_not( filename );
+
+        char magic[sizeof(RECORDSTATS_MAGIC)];
+        file.read( magic, sizeof(magic) );
+        if( file.fail( ) || memcmp( magic, RECORDSTATS_MAGIC, sizeof(magic) ) != 0 )
+            throw exception::serialization_error( filename + " is not a record statistics file" );
+
+        uint32 ns;
+        uint64 num_records;
+        readLittleEndian( file, ns );
+        readLittleEndian( file, num_records );
+        if( file.fail( ) )
+            throw exception::serialization_error( "record statistics file " + filename + " is truncated" );
+
+        // sizes from the file are checked against its length before anything is allocated
+        std::streampos pos = file.tellg( );
+        file.seekg( 0, std::ios_base::end );
+        uint64 remaining = static_cast<uint64>( file.tellg( ) - pos );
+        file.seekg( pos );
+        if( uint64( ns ) * sizeof(uint32) > remaining )
+            throw exception::serialization_error( "record statistics file " + filename + " is truncated" );
+        remaining -= uint64( ns ) * sizeof(uint32);
+        if( ns > 0 && num_records > remaining / ( uint64( ns ) * RECORDSTATS_ENTRY_SIZE ) )
+            throw exception::serialization_error( "record statistics file " + filename + " is truncated" );
+
+        std::vector<size_t> spr( ns );
+        for( size_t i=0; i<ns; i++ )
+        {
+            uint32 s;
+            readLittleEndian( file, s );
+            spr[i] = s;
+        }
+        if( file.fail( ) )
+            throw exception::serialization_error( "record statistics file " + filename + " is truncated" );
+
+        std::vector<RecordStat> stats( boost::numeric_cast<size_t>( num_records ) * ns );
+        if( !stats.empty( ) )
+        {
+            std::vector<char> raw( stats.size( ) * RECORDSTATS_ENTRY_SIZE );
+            file.read( &raw[0], raw.size( ) );
+            if( file.fail( ) )
+                throw exception::serialization_error( "record statistics file " + filename + " is truncated" );
+            for( size_t n=0; n<stats.size(); n++ )
+            {
+                const char *p = &raw[n * RECORDSTATS_ENTRY_SIZE];
+                readLittleEndian( p, stats[n].min );
+                readLittleEndian( p + 4, stats[n].max );
+                readLittleEndian( p + 8, stats[n].mean );
+                readLittleEndian( p + 12, stats[n].rms );
+                readLittleEndian( p + 16, stats[n].nan_count );
+            }
+        }
+
+        m_spr.swap( spr );
+        m_stats.swap( stats );
+        m_num_records = boost::numeric_cast<size_t>( num_records );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    bool RecordStatsIndex::matches( const GDFHeaderAccess &header ) const
+    {
+        if( header.getMainHeader_readonly( ).get_num_datarecords( ) != int64( m_num_records ) )
+            return false;
+        if( header.getMainHeader_readonly( ).get_num_signals( ) != m_spr.size( ) )
+            return false;
+        for( size_t i=0; i<m_spr.size(); i++ )
+            if( header.getSignalHeader_readonly( i ).get_samples_per_record( ) != m_spr[i] )
+                return false;
+        return true;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    size_t RecordStatsIndex::getSamplesPerRecord( uint16 channel ) const
+    {
+        if( channel >= m_spr.size( ) )
+            throw exception::nonexistent_channel_access( boost::lexical_cast<std::string>( channel ) );
+        return m_spr[channel];
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    const RecordStat &RecordStatsIndex::get( size_t record, uint16 channel ) const
+    {
+        if( channel >= m_spr.size( ) )
+            throw exception::nonexistent_channel_access( boost::lexical_cast<std::string>( channel ) );
+        if( record >= m_num_records )
+            throw exception::index_out_of_range( "record " + boost::lexical_cast<std::string>( record ) );
+        return m_stats[record * m_spr.size( ) + channel];
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    RecordStat RecordStatsIndex::getSummary( uint16 channel, size_t first_record, size_t last_record ) const
+    {
+        size_t spr = getSamplesPerRecord( channel );
+        last_record = std::min( last_record, m_num_records );
+
+        double mn = std::numeric_limits<double>::infinity( );
+        double mx = -std::numeric_limits<double>::infinity( );
+        double sum = 0, sumsq = 0;
+        uint64 n = 0, nans = 0;
+        for( size_t r=first_record; r<last_record; r++ )
+        {
+            const RecordStat &s = m_stats[r * m_spr.size( ) + channel];
+            nans += s.nan_count;
+            size_t k = spr - s.nan_count;
+            if( k == 0 )
+                continue;
+            mn = std::min( mn, double( s.min ) );
+            mx = std::max( mx, double( s.max ) );
+            sum += double( s.mean ) * k;
+            sumsq += double( s.rms ) * s.rms * k;
+            n += k;
+        }
+
+        RecordStat s;
+        s.nan_count = boost::numeric_cast<uint32>( nans );
+        if( n == 0 )
+        {
+            s.min = s.max = s.mean = s.rms = std::numeric_limits<float32>::quiet_NaN( );
+            return s;
+        }
+        s.min = static_cast<float32>( mn );
+        s.max = static_cast<float32>( mx );
+        s.mean = static_cast<float32>( sum / n );
+        s.rms = static_cast<float32>( sqrt( sumsq / n ) );
+        return s;
+    }
+}
@@ -67,25 +67,16 @@ namespace gdf {
     //===================================================================================================
     //===================================================================================================
 
-    double SignalHeader::phys_to_raw( const double phy ) const
+    void SignalHeader::updateCalibration( )
     {
         double digmin = get_digmin( );
         double digmax = get_digmax( );
         double physmin = get_physmin( );
         double physmax = get_physmax( );
-        return (phy-physmin)*(digmax-digmin)/(physmax-physmin)+digmin;
-    }
-
-    //===================================================================================================
-    //===================================================================================================
-
-    double SignalHeader::raw_to_phys( const double raw ) const
-    {
-        double digmin = get_digmin( );
-        double digmax = get_digmax( );
-        double physmin = get_physmin( );
-        double physmax = get_physmax( );
-        return (raw-digmin)*(physmax-physmin)/(digmax-digmin)+physmin;
+        m_raw_to_phys_scale = ( physmax - physmin ) / ( digmax - digmin );
+        m_raw_to_phys_offset = physmin - digmin * m_raw_to_phys_scale;
+        m_phys_to_raw_scale = ( digmax - digmin ) / ( physmax - physmin );
+        m_phys_to_raw_offset = digmin - physmin * m_phys_to_raw_scale;
     }
 
     //===================================================================================================
@@ -17,16 +17,22 @@
 // Copyright 2010, 2013 Martin Billinger, Owen Kelly
 
 #include "GDF/Writer.h"
+#include "GDF/Conversion.h"
+#include "GDF/DataSource.h"
 #include "GDF/Exceptions.h"
 #include "GDF/Record.h"
 #include "GDF/tools.h"
 #include <iostream>
+#include <limits>
+#include <math.h>
+#include <vector>
 
 namespace gdf
 {
-    Writer::Writer( ) : m_recbuf( &m_header ), m_eventbuffer( NULL )
+    Writer::Writer( ) : m_recbuf( &m_header ), m_sink( NULL ), m_owns_sink( false ), m_sinkbuf( NULL ), m_file( NULL ), m_eventbuffer( NULL )
     {
         m_eventbuffermemory = writer_ev_file;
+        m_record_stats_enabled = false;
         setMaxFullRecords( 0 );
         m_recbuf.registerRecordFullCallback( this );
     }
@@ -37,7 +43,7 @@ namespace gdf
     Writer::~Writer( )
     {
         //std::cout << "~Writer( )" << std::endl;
-        if( m_file.is_open( ) )
+        if( m_sink != NULL )
             close( );
     }
 
@@ -46,13 +52,52 @@ namespace gdf
 
     void Writer::open(const int flags )
     {
-        if( m_file.is_open() )
+        if( m_sink != NULL )
             throw exception::file_open( "" );
 
-        assert( !m_file.is_open() );
+        if( !(flags & writer_overwrite) )
+        {
+            std::ifstream test( m_filename.c_str(), std::ios_base::in );
+            if( !test.fail() )
+                throw exception::file_exists( m_filename );
+        }
+
+        std::list< std::string > wmsg = sanitizeHeader( );
+
+        DataSink *sink;
+        try
+        {
+            sink = new FileSink( m_filename );
+        }
+        catch( exception::serialization_error & )
+        {
+            throw std::invalid_argument( "Error opening file for writing." );
+        }
+        openSink( sink, true, flags, wmsg );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Writer::open( DataSink &sink, const int flags )
+    {
+        if( m_sink != NULL )
+            throw exception::file_open( "" );
+
+        m_filename = "";
+        std::list< std::string > wmsg = sanitizeHeader( );
+        openSink( &sink, false, flags | writer_ev_memory, wmsg );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    std::list< std::string > Writer::sanitizeHeader( )
+    {
+        // unknown until the writer is closed
+        m_header.getMainHeader( ).set_num_datarecords( -1 );
         m_header.setLock( true );
 
-        bool warn = false;
         std::list< std::string > wmsg;
         try {
             m_header.sanitize( );
@@ -61,34 +106,26 @@ namespace gdf
             wmsg = e.warnings;
             if( e.errors.size() != 0 )
                 throw e;
-            if( e.warnings.size() != 0 )
-                warn = true;
         }
+        return wmsg;
+    }
 
-        if( !(flags & writer_overwrite) )
-        {
-            m_file.open( m_filename.c_str(), std::ios_base::in );
-            if( !m_file.fail() )
-            {
-                m_header.setLock( false );
-                m_file.close( );
-                throw exception::file_exists( m_filename );
-            }
-        }
+    //===================================================================================================
+    //===================================================================================================
 
+    void Writer::openSink( DataSink *sink, bool owns_sink, const int flags, const std::list< std::string > &wmsg )
+    {
+        m_sink = sink;
+        m_owns_sink = owns_sink;
+        m_sinkbuf = new SinkStreamBuf( *m_sink );
+        m_file.rdbuf( m_sinkbuf );
         m_file.clear( );
 
-        m_file.open( m_filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
-
-        if( m_file.fail() )
-        {
-            throw std::invalid_argument( "Error opening file for writing." );
-        }
-
         m_eventbuffermemory = flags & writer_ev_memory;
         if( m_eventbuffermemory )
         {
             m_eventbuffer.rdbuf( m_evbuf_memory.rdbuf() );
+            m_evbuf_memory.str( "" );
             m_evbuf_memory.clear( );
         }
         else
@@ -99,11 +136,13 @@ namespace gdf
 
         m_recbuf.reset( );
         m_num_datarecords = 0;
+        if( m_record_stats_enabled )
+            m_record_stats.reset( m_header );
 
         m_file << m_header;
         m_file.flush( );
 
-        if( warn )
+        if( wmsg.size() != 0 )
             throw exception::header_issues( wmsg );
     }
 
@@ -121,7 +160,7 @@ namespace gdf
 
     void Writer::close( )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             return;
             //throw exception::file_not_open( "" );
 
@@ -148,12 +187,25 @@ namespace gdf
 
         m_header.setLock( false );
 
-        getMainHeader().set_num_datarecords( m_num_datarecords );
+        // sinks that can not seek keep -1 (unknown) as number of records
+        if( m_sink->isSeekable( ) )
+        {
+            getMainHeader().set_num_datarecords( m_num_datarecords );
+            m_file.seekp( getMainHeader_readonly().num_datarecords.pos );
+            getMainHeader().num_datarecords.tostream( m_file );
+        }
+        m_file.flush( );
 
-        m_file.seekp( getMainHeader_readonly().num_datarecords.pos );
-        getMainHeader().num_datarecords.tostream( m_file );
+        m_file.rdbuf( NULL );
+        delete m_sinkbuf;
+        m_sinkbuf = NULL;
+        if( m_owns_sink )
+            delete m_sink;
+        m_sink = NULL;
+        m_owns_sink = false;
 
-        m_file.close( );
+        if( m_record_stats_enabled && !m_filename.empty( ) )
+            m_record_stats.save( RecordStatsIndex::getSidecarName( m_filename ) );
     }
 
     //===================================================================================================
@@ -161,7 +213,7 @@ namespace gdf
 
     bool Writer::isOpen( )
     {
-        return m_file.is_open( );
+        return m_sink != NULL;
     }
 
     //===================================================================================================
@@ -183,6 +235,24 @@ namespace gdf
     //===================================================================================================
     //===================================================================================================
 
+    void Writer::enableSaturation( bool b )
+    {
+        m_recbuf.enableSaturation( b );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
+    void Writer::enableRecordStats( bool b )
+    {
+        if( m_sink != NULL )
+            throw exception::file_open( "when attempting to enable record statistics" );
+        m_record_stats_enabled = b;
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
     bool Writer::createSignal( size_t index, bool throwexc )
     {
         return m_header.createSignal( index, throwexc );
@@ -217,7 +287,7 @@ namespace gdf
 
     void Writer::blitFromSerialBufferPhys( const double *buf, const std::vector<size_t> &samples_per_channel )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
 
         size_t M = samples_per_channel.size( );
@@ -248,7 +318,7 @@ namespace gdf
 
     void Writer::addSamplePhys( const size_t channel_idx, const float64 value )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
         m_recbuf.addSamplePhys( channel_idx, value );
     }
@@ -258,7 +328,7 @@ namespace gdf
 
     void Writer::blitSamplesPhys( const size_t channel_idx, const float64 *values, size_t num )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
         m_recbuf.blitSamplesPhys( channel_idx, values, num );
     }
@@ -268,7 +338,7 @@ namespace gdf
 
     void Writer::blitSamplesPhys( const size_t channel_idx, const std::vector<float64> &values )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
         m_recbuf.blitSamplesPhys( channel_idx, &values[0], values.size() );
     }
@@ -294,11 +364,13 @@ namespace gdf
 
     void Writer::writeRecord( )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
         Record *r = m_recbuf.getFirstFullRecord( );
         if( r != NULL )
         {
+            if( m_record_stats_enabled )
+                m_record_stats.addRecord( r );
             m_file << *r;
             m_recbuf.removeFirstFullRecord( );
             m_num_datarecords++;
@@ -310,6 +382,8 @@ namespace gdf
 
     void Writer::writeRecordDirect( Record *r )
     {
+        if( m_record_stats_enabled )
+            m_record_stats.addRecord( r );
         m_file << *r;
         m_num_datarecords++;
     }
@@ -320,7 +394,7 @@ namespace gdf
     void Writer::flush( )
     {
         //std::cout << "Writer::flush( )" << std::endl;
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
         size_t R = m_recbuf.getNumFullRecords();
 
@@ -333,7 +407,7 @@ namespace gdf
 
     void Writer::setEventMode( uint8 mode )
     {
-        if( m_file.is_open() )
+        if( m_sink != NULL )
             throw exception::file_open( "" );
         m_header.getEventHeader( ).setMode( mode );
     }
@@ -343,7 +417,7 @@ namespace gdf
 
     void Writer::setEventSamplingRate( float32 fs )
     {
-        if( m_file.is_open() )
+        if( m_sink != NULL )
             throw exception::file_open( "" );
         m_header.getEventHeader( ).setSamplingRate( fs );
     }
@@ -353,7 +427,7 @@ namespace gdf
 
     void Writer::addEvent( const Mode1Event &ev )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
         if( m_header.getEventHeader( ).getMode() != 1 )
             throw exception::wrong_eventmode( "Expected mode 1" );
@@ -365,7 +439,7 @@ namespace gdf
 
     void Writer::addEvent( uint32 position, uint16 type )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
         Mode1Event ev;
         ev.position = position;
@@ -378,7 +452,7 @@ namespace gdf
 
     void Writer::addEvent( const Mode3Event &ev )
     {
-        if( !m_file.is_open() )
+        if( m_sink == NULL )
             throw exception::file_not_open( "" );
         if( m_header.getEventHeader( ).getMode() != 3 )
             throw exception::wrong_eventmode( "Expected mode 3" );
@@ -430,6 +504,62 @@ namespace gdf
 	//===================================================================================================
     //===================================================================================================
 
+    void Writer::addSparseSamples( uint16 channel, const double *times, const double *values, size_t num )
+    {
+        if( m_sink == NULL )
+            throw exception::file_not_open( "" );
+        EventHeader &eh = m_header.getEventHeader( );
+        if( eh.getMode() != 3 )
+            throw exception::wrong_eventmode( "Expected mode 3" );
+        if( channel == 0 || channel > m_header.getNumSignals( ) )
+            throw exception::event_conversion_error( "NEQS sample needs a valid CHN; samples not converted to events." );
+        const SignalHeader &sh = getSignalHeader_readonly( channel - 1 );
+        uint32 datatype = sh.get_datatype( );
+        if( datatype > UINT32 && datatype != FLOAT32 )
+            throw exception::event_conversion_error( "Invalid data type for NEQS sample; sample not converted to event." );
+        double efs = eh.getSamplingRate( );
+        if( efs <= 0 )
+            throw exception::invalid_operation( "Event table m_efs not set or not valid." );
+        if( num == 0 )
+            return;
+
+        // positions as in EventHeader::secToPos; all are checked before anything is written
+        std::vector<Mode3Event> events( num );
+        for( size_t i=0; i<num; i++ )
+        {
+            double raw_pos = ceil( times[i] * efs );
+            if( !( raw_pos >= 0 ) )
+                throw exception::invalid_operation( "Event time < 0 [sec] not allowed." );
+            if( raw_pos >= std::numeric_limits<int32>::max( ) )
+                throw exception::invalid_operation( "Event time too large." );
+            events[i].position = 1 + static_cast<uint32>( raw_pos );
+            events[i].type = 0x7fff;
+            events[i].channel = channel;
+        }
+
+        // quantize the whole batch; throws before anything is written unless saturating
+        bool saturate = m_recbuf.getSaturation( );
+        if( datatype == FLOAT32 )
+        {
+            std::vector<float32> raw( num );
+            convertPhysToRaw( values, &raw[0], num, sh.getPhysToRawScale( ), sh.getPhysToRawOffset( ), saturate );
+            for( size_t i=0; i<num; i++ )
+                events[i].value = raw[i];
+        }
+        else
+        {
+            std::vector<uint32> raw( num );
+            convertPhysToRaw( values, &raw[0], num, sh.getPhysToRawScale( ), sh.getPhysToRawOffset( ), saturate );
+            for( size_t i=0; i<num; i++ )
+                events[i].duration = raw[i];
+        }
+
+        m_eventbuffer.write( reinterpret_cast<const char*>( &events[0] ), num * sizeof(Mode3Event) );
+    }
+
+    //===================================================================================================
+    //===================================================================================================
+
     void Writer::addEvent( uint32 position, uint16 type, uint16 channel, float32 value )
     {
         Mode3Event ev;
@@ -0,0 +1,180 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/DataSource.h>
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdlib.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+void compareRecord( gdf::Reader &r, gdf::Record *a, gdf::Record *b )
+{
+    for( size_t ch=0; ch<r.getMainHeader_readonly( ).get_num_signals( ); ch++ )
+    {
+        size_t spr = r.getSignalHeader_readonly( ch ).get_samples_per_record( );
+        for( size_t i=0; i<spr; i++ )
+            if( !same( a->getChannel( ch )->getSamplePhys( i ), b->getChannel( ch )->getSamplePhys( i ) ) )
+                throw(std::invalid_argument("ERROR -- Records differ."));
+    }
+}
+
+int main( )
+{
+    try
+    {
+        srand( 42 );
+
+        cout << "Batched reads from file .... ";
+        gdf::FileSource source( reffile0 );
+        size_t chunk = 100;
+        size_t num = boost::numeric_cast<size_t>( source.size( ) / chunk );
+        std::vector<char> batched( num * chunk ), single( num * chunk );
+        std::vector<gdf::ReadRequest> requests;
+        for( size_t i=0; i<num; i++ )
+        {
+            // reverse order, so that completion order differs from file order
+            gdf::ReadRequest rq;
+            rq.offset = ( num - 1 - i ) * chunk;
+            rq.buffer = &batched[i*chunk];
+            rq.bytes = chunk;
+            requests.push_back( rq );
+            source.readAt( rq.offset, &single[i*chunk], chunk );
+        }
+        source.readBatch( requests );
+        if( batched != single )
+            throw(std::invalid_argument("ERROR -- Batched reads differ."));
+        cout << "OK" << ( source.usesIoUring( ) ? " (io_uring)" : "" ) << endl;
+
+        cout << "Batched read past end of file .... ";
+        requests.resize( 1 );
+        requests[0].offset = source.size( ) - 10;
+        requests[0].bytes = 20;
+        requests.push_back( requests[0] );
+        try
+        {
+            source.readBatch( requests );
+            throw(std::invalid_argument("ERROR -- Expected exception."));
+        }
+        catch( gdf::exception::serialization_error & ) { }
+        cout << "OK" << endl;
+
+        std::vector<string> infilelist;
+        infilelist.push_back(reffile0);
+        infilelist.push_back(alltypesfile);
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+            cout << "Opening '" << reffile << "' for reading." << endl;
+
+            gdf::Reader r_ref;
+            r_ref.open( reffile );
+            size_t num_recs = boost::numeric_cast<size_t>( r_ref.getMainHeader_readonly( ).get_num_datarecords( ) );
+
+            std::vector<size_t> indices;
+            for( size_t i=0; i<500; i++ )
+                indices.push_back( rand( ) % num_recs );
+            indices.push_back( indices[0] );    // duplicate
+            if( num_recs > 3 )
+            {
+                indices.push_back( num_recs-2 );    // consecutive run
+                indices.push_back( num_recs-1 );
+                indices.push_back( num_recs-3 );
+            }
+
+            cout << "Precaching scattered records .... ";
+            gdf::Reader r_batch;
+            r_batch.open( reffile );
+            r_batch.precacheRecords( indices );
+            size_t misses = r_batch.getCacheMisses( );
+            for( size_t i=0; i<indices.size(); i++ )
+                compareRecord( r_ref, r_ref.getRecordPtr( indices[i] ), r_batch.getRecordPtr( indices[i] ) );
+            if( r_batch.getCacheMisses( ) != misses )
+                throw(std::invalid_argument("ERROR -- Precached records were not cached."));
+            r_batch.close( );
+            cout << "OK" << endl;
+
+            cout << "Precaching with limited cache .... ";
+            gdf::Reader r_limited;
+            r_limited.setMaxCacheRecords( 7 );
+            r_limited.open( reffile );
+            r_limited.precacheRecords( indices );
+            if( r_limited.getNumCachedRecords( ) > 7 )
+                throw(std::invalid_argument("ERROR -- Cache limit exceeded."));
+            for( size_t i=0; i<indices.size(); i++ )
+                compareRecord( r_ref, r_ref.getRecordPtr( indices[i] ), r_limited.getRecordPtr( indices[i] ) );
+            r_limited.close( );
+            cout << "OK" << endl;
+
+            cout << "Precaching read ahead records .... ";
+            gdf::Reader r_prefetch;
+            r_prefetch.enablePrefetch( 8 );
+            r_prefetch.open( reffile );
+            r_prefetch.getRecordPtr( 0 );
+            r_prefetch.getRecordPtr( 1 );
+            std::vector<size_t> ahead;
+            for( size_t i=2; i<std::min( num_recs, size_t(10) ); i++ )
+                ahead.push_back( i );
+            r_prefetch.precacheRecords( ahead );
+            misses = r_prefetch.getCacheMisses( );
+            for( size_t i=0; i<ahead.size(); i++ )
+                compareRecord( r_ref, r_ref.getRecordPtr( ahead[i] ), r_prefetch.getRecordPtr( ahead[i] ) );
+            if( r_prefetch.getCacheMisses( ) != misses )
+                throw(std::invalid_argument("ERROR -- Precached records were not cached."));
+            r_prefetch.close( );
+            cout << "OK" << endl;
+
+            cout << "Precaching invalid record .... ";
+            std::vector<size_t> invalid( 1, num_recs );
+            try
+            {
+                r_ref.precacheRecords( invalid );
+                throw(std::invalid_argument("ERROR -- Expected exception."));
+            }
+            catch( gdf::exception::index_out_of_range & ) { }
+            cout << "OK" << endl;
+
+            r_ref.close( );
+        }
+
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
@@ -0,0 +1,165 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include <GDF/GDFHeaderAccess.h>
+#include <GDF/Reader.h>
+
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string testfile = "testblockread.gdf.tmp";
+const size_t block_size = 4*1024*1024;  // Reader reads uncached records in blocks of this many bytes
+
+/// Sample n of channel ch in the generated files
+double value( size_t ch, size_t n )
+{
+    return static_cast<double>( ( n * 7 + ch * 1000003 ) % 2000000 ) - 1000000.0;
+}
+
+/// Write a file with int32 channels where raw and physical values are equal.
+/** The records are serialized directly instead of through Writer, which preallocates a pool of records and would
+    need gigabytes of memory for records larger than a block. */
+void writeFile( size_t num_signals, size_t spr, size_t num_records )
+{
+    gdf::GDFHeaderAccess header;
+    header.getEventHeader( ).setSamplingRate( 100 );
+    header.setRecordDuration( 1, 1 );
+    for( size_t ch=0; ch<num_signals; ch++ )
+    {
+        header.createSignal( ch );
+        header.getSignalHeader( ch ).set_label( "block" );
+        header.getSignalHeader( ch ).set_datatype( gdf::INT32 );
+        header.getSignalHeader( ch ).set_samplerate( boost::numeric_cast<gdf::uint32>( spr ) );
+        header.getSignalHeader( ch ).set_digmin( -1e9 );
+        header.getSignalHeader( ch ).set_digmax( 1e9 );
+        header.getSignalHeader( ch ).set_physmin( -1e9 );
+        header.getSignalHeader( ch ).set_physmax( 1e9 );
+    }
+
+    try {
+        header.sanitize( );
+    } catch( gdf::exception::header_issues &e )
+    {
+        if( e.num_errors() > 0 ) throw;
+    }
+    header.getMainHeader( ).set_num_datarecords( boost::numeric_cast<gdf::int64>( num_records ) );
+
+    std::ofstream file( testfile.c_str( ), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+    file << header;
+    for( size_t rec=0; rec<num_records; rec++ )
+        for( size_t ch=0; ch<num_signals; ch++ )
+            for( size_t i=0; i<spr; i++ )
+                gdf::writeLittleEndian( file, static_cast<gdf::int32>( value( ch, rec * spr + i ) ) );
+    header.getEventHeader( ).toStream( file );
+}
+
+/// Compare a single channel block read of samples [start,end) with the generated values
+void checkWindow( gdf::Reader &r, gdf::uint16 ch, size_t start, size_t end )
+{
+    std::vector<double> buffer( end - start );
+    r.getSignal( ch, &buffer[0], start, end );
+    for( size_t n=0; n<buffer.size(); n++ )
+        if( buffer[n] != value( ch, start + n ) )
+            throw(std::invalid_argument("ERROR -- Block read window differs."));
+}
+
+/// Compare block reads with the generated values and with per record reads through the record cache
+void checkFile( size_t num_signals, size_t spr, size_t num_records )
+{
+    gdf::Reader r_block, r_record;
+    r_block.enableCache( false );
+    r_block.open( testfile );
+    r_record.open( testfile );
+
+    size_t record_length = num_signals * spr * sizeof( gdf::int32 );
+    size_t block_records = std::max( block_size / record_length, size_t(1) );
+
+    std::vector< std::vector< double > > buffer;
+    r_block.getSignals( buffer );
+    if( buffer.size( ) != num_signals )
+        throw(std::invalid_argument("ERROR -- Wrong number of signals."));
+    for( size_t ch=0; ch<num_signals; ch++ )
+    {
+        if( buffer[ch].size( ) != spr * num_records )
+            throw(std::invalid_argument("ERROR -- Wrong number of samples."));
+        for( size_t n=0; n<buffer[ch].size(); n++ )
+            if( buffer[ch][n] != value( ch, n ) )
+                throw(std::invalid_argument("ERROR -- Block read differs."));
+    }
+
+    // windows across every block boundary, and the last (partial) block on its own
+    for( size_t b=block_records; b<num_records; b+=block_records )
+        for( gdf::uint16 ch=0; ch<num_signals; ch++ )
+            checkWindow( r_block, ch, b * spr - spr / 2 - 1, std::min( b * spr + spr + 3, num_records * spr ) );
+    size_t last_block = ( ( num_records - 1 ) / block_records ) * block_records;
+    checkWindow( r_block, 0, last_block * spr + 1, num_records * spr );
+
+    // per record reads of the records on both sides of each block boundary
+    for( size_t b=block_records; b<=num_records; b+=block_records )
+        for( size_t rec=b-1; rec<=b && rec<num_records; rec++ )
+            for( gdf::uint16 ch=0; ch<num_signals; ch++ )
+            {
+                gdf::Channel *c = r_record.getRecordPtr( rec )->getChannel( ch );
+                for( size_t i=0; i<spr; i++ )
+                    if( c->getSamplePhys( i ) != buffer[ch][rec * spr + i] )
+                        throw(std::invalid_argument("ERROR -- Block read differs from record read."));
+            }
+
+    if( r_block.getSample( 0, num_records * spr - 1 ) != value( 0, num_records * spr - 1 ) )
+        throw(std::invalid_argument("ERROR -- Last sample differs."));
+
+    r_block.close( );
+    r_record.close( );
+}
+
+int main( )
+{
+    try
+    {
+        // 8000 byte records: 524 records per block, so blocks end in the middle of the file and the last one is partial
+        cout << "Checking block reads of small records .... ";
+        writeFile( 2, 1000, 800 );
+        checkFile( 2, 1000, 800 );
+        cout << "OK" << endl;
+
+        // 4.4 MB records do not fit into one block and are read one at a time
+        cout << "Checking block reads of records larger than a block .... ";
+        writeFile( 1, 1100000, 2 );
+        checkFile( 1, 1100000, 2 );
+        cout << "OK" << endl;
+
+        remove( testfile.c_str() );
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    remove( testfile.c_str() );
+    return 1;   // test failed
+}
@@ -0,0 +1,123 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+#include <GDF/SignalHeader.h>
+
+#include <iostream>
+#include <math.h>
+
+using namespace std;
+
+const string reffile = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+
+bool approx( double a, double b )
+{
+    return fabs( a - b ) <= 1e-12 * std::max( 1.0, std::max( fabs( a ), fabs( b ) ) );
+}
+
+/// Check the cached calibration of sh against the current physmin, physmax, digmin and digmax
+bool checkCalibration( const gdf::SignalHeader &sh )
+{
+    double scale = ( sh.get_physmax( ) - sh.get_physmin( ) ) / ( sh.get_digmax( ) - sh.get_digmin( ) );
+    double offset = sh.get_physmin( ) - sh.get_digmin( ) * scale;
+    if( !approx( sh.getRawToPhysScale( ), scale ) || !approx( sh.getRawToPhysOffset( ), offset ) )
+        return false;
+    if( !approx( sh.getPhysToRawScale( ), 1.0 / scale ) || !approx( sh.getPhysToRawOffset( ), -offset / scale ) )
+        return false;
+    // the ends of the digital range map to the ends of the physical range
+    if( !approx( sh.raw_to_phys( sh.get_digmin( ) ), sh.get_physmin( ) ) || !approx( sh.raw_to_phys( sh.get_digmax( ) ), sh.get_physmax( ) ) )
+        return false;
+    if( !approx( sh.phys_to_raw( sh.get_physmin( ) ), sh.get_digmin( ) ) || !approx( sh.phys_to_raw( sh.get_physmax( ) ), sh.get_digmax( ) ) )
+        return false;
+    return true;
+}
+
+int main( )
+{
+    try
+    {
+        cout << "Changing calibration fields one at a time .... ";
+        gdf::SignalHeader sh;
+        sh.set_physmin( -1 );
+        sh.set_physmax( 1 );
+        sh.set_digmin( -100 );
+        sh.set_digmax( 100 );
+        if( !checkCalibration( sh ) || sh.raw_to_phys( 50 ) != 0.5 )
+            throw(std::invalid_argument("ERROR -- Initial calibration wrong."));
+        sh.set_physmax( 3 );
+        if( !checkCalibration( sh ) )
+            throw(std::invalid_argument("ERROR -- Calibration not updated after set_physmax."));
+        sh.set_physmin( -5 );
+        if( !checkCalibration( sh ) )
+            throw(std::invalid_argument("ERROR -- Calibration not updated after set_physmin."));
+        sh.set_digmax( 1000 );
+        if( !checkCalibration( sh ) )
+            throw(std::invalid_argument("ERROR -- Calibration not updated after set_digmax."));
+        sh.set_digmin( 0 );
+        if( !checkCalibration( sh ) || sh.raw_to_phys( 500 ) != -1 )
+            throw(std::invalid_argument("ERROR -- Calibration not updated after set_digmin."));
+        cout << "OK" << endl;
+
+        cout << "Changing calibration fields by name .... ";
+        sh.setNumeric( "physmin", 0 );
+        sh.setNumeric( "physmax", 10 );
+        sh.setNumeric( "digmin", 0 );
+        sh.setNumeric( "digmax", 5 );
+        if( !checkCalibration( sh ) || sh.getRawToPhysScale( ) != 2 )
+            throw(std::invalid_argument("ERROR -- Calibration not updated after setNumeric."));
+        cout << "OK" << endl;
+
+        cout << "Copying calibration .... ";
+        gdf::SignalHeader copy;
+        copy.copyFrom( sh );
+        if( !checkCalibration( copy ) || copy.getRawToPhysScale( ) != sh.getRawToPhysScale( ) )
+            throw(std::invalid_argument("ERROR -- Calibration not copied."));
+        copy.setDefaultValues( );
+        copy.set_physmin( 10 );
+        copy.set_physmax( 20 );
+        copy.set_digmin( 1 );
+        copy.set_digmax( 11 );
+        if( !checkCalibration( copy ) || !checkCalibration( sh ) )
+            throw(std::invalid_argument("ERROR -- Calibration not updated after reset."));
+        cout << "OK" << endl;
+
+        cout << "Reading calibration from file .... ";
+        gdf::Reader r;
+        r.open( reffile );
+        for( size_t ch=0; ch<r.getMainHeader_readonly( ).get_num_signals( ); ch++ )
+            if( !checkCalibration( r.getSignalHeader_readonly( ch ) ) )
+                throw(std::invalid_argument("ERROR -- Calibration of file header wrong."));
+        r.close( );
+        cout << "OK" << endl;
+
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
@@ -0,0 +1,127 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+// walks all windows of a cursor and compares them with the complete signals
+void checkCursor( gdf::ChunkCursor cursor, const std::vector< std::vector< double > > &ref )
+{
+    size_t N = ref[0].size( );
+    size_t expected_pos = 0;
+    size_t num_windows = 0;
+    while( cursor.next( ) )
+    {
+        if( cursor.getPosition( ) != expected_pos )
+            throw(std::invalid_argument("ERROR -- Wrong window position."));
+        if( cursor.getNumSamples( ) != std::min( cursor.getChunkSamples( ), N - expected_pos ) )
+            throw(std::invalid_argument("ERROR -- Wrong window length."));
+        for( size_t i=0; i<cursor.getNumChannels( ); i++ )
+            for( size_t n=0; n<cursor.getNumSamples( ); n++ )
+                if( !same( cursor.getChannel( i )[n], ref[cursor.getSignalIndices( )[i]][expected_pos+n] ) )
+                    throw(std::invalid_argument("ERROR -- Window samples differ."));
+        expected_pos += cursor.getHop( );
+        num_windows++;
+    }
+    if( num_windows != ( N + cursor.getHop( ) - 1 ) / cursor.getHop( ) )
+        throw(std::invalid_argument("ERROR -- Wrong number of windows."));
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            for( int flags=gdf::reader_default; flags<=gdf::reader_mmap; flags++ )
+            {
+                gdf::Reader r;
+                cout << "Opening '" << reffile << "' for reading." << endl;
+                r.open( reffile, flags );
+
+                std::vector< std::vector< double > > ref;
+                r.getSignals( ref );
+                r.resetCache( );
+
+                std::vector<gdf::uint16> channels;
+                channels.push_back( boost::numeric_cast<gdf::uint16>( ref.size( ) - 1 ) );
+                channels.push_back( 0 );
+                size_t spr = r.getSignalHeader_readonly( 0 ).get_samples_per_record( );
+                size_t N = ref[0].size( );
+
+                cout << "Comparing non-overlapping windows .... ";
+                checkCursor( r.scan( channels, spr + 3 ), ref );
+                cout << "OK" << endl;
+
+                cout << "Comparing overlapping windows .... ";
+                checkCursor( r.scan( channels, 3 * spr + 1, spr / 2 + 1 ), ref );
+                checkCursor( r.scan( std::vector<gdf::uint16>( ), N / 3 + 1, 1 + N / 7 ), ref );
+                cout << "OK" << endl;
+
+                cout << "Comparing windows with gaps .... ";
+                checkCursor( r.scan( channels, 2, 2 * spr + 1 ), ref );
+                cout << "OK" << endl;
+
+                cout << "Checking reset and cache .... ";
+                gdf::ChunkCursor cursor = r.scan( channels, spr );
+                while( cursor.next( ) ) { }
+                cursor.reset( );
+                if( !cursor.next( ) || cursor.getPosition( ) != 0 )
+                    throw(std::invalid_argument("ERROR -- reset failed."));
+                if( r.getNumCachedRecords( ) != 0 )
+                    throw(std::invalid_argument("ERROR -- Cursor filled the record cache."));
+                cout << "OK" << endl;
+
+                r.close( );
+            }
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
@@ -0,0 +1,176 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/ConcurrentReader.h>
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/bind/bind.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+#include <boost/thread/thread.hpp>
+
+using namespace std;
+
+const string reffile = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const size_t num_threads = 4;
+const size_t num_rounds = 8;
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+/// Each worker repeatedly reads its own window of all channels and a single channel
+void worker( gdf::ConcurrentReader *cr, const std::vector< std::vector< double > > *reference, size_t id, bool *ok )
+{
+    try
+    {
+        size_t N = (*reference)[0].size( );
+        double fs = cr->getSignalHeader_readonly( 0 ).get_samplerate( );
+        size_t first = id * N / num_threads;
+        size_t last = ( id + 1 ) * N / num_threads;
+
+        for( size_t round=0; round<num_rounds; round++ )
+        {
+            std::vector< std::vector< double > > buffer;
+            cr->getSignals( buffer, first / fs, last / fs );
+            for( size_t ch=0; ch<buffer.size(); ch++ )
+                for( size_t n=0; n<buffer[ch].size(); n++ )
+                    if( !same( buffer[ch][n], (*reference)[ch][first+n] ) )
+                        return;
+
+            std::vector<double> single( last - first );
+            gdf::uint16 ch = boost::numeric_cast<gdf::uint16>( ( id + round ) % reference->size( ) );
+            cr->getSignal( ch, &single[0], first, last );
+            for( size_t n=0; n<single.size(); n++ )
+                if( !same( single[n], (*reference)[ch][first+n] ) )
+                    return;
+        }
+        *ok = true;
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception in worker: " << e.what( ) << endl;
+    }
+}
+
+int main( )
+{
+    try
+    {
+        cout << "Reading reference signals from '" << reffile << "'." << endl;
+        gdf::Reader r;
+        r.open( reffile );
+        std::vector< std::vector< double > > reference;
+        r.getSignals( reference );
+        size_t num_events = r.getEventHeader( )->getNumEvents( );
+        bool thrown = false;
+        try {
+            r.getSample( 0, reference[0].size( ) );
+        } catch( gdf::exception::index_out_of_range & ) {
+            thrown = true;
+        }
+        if( !thrown )
+            throw(std::invalid_argument("ERROR -- Reader accepted a sample past the end."));
+        r.close( );
+
+        for( int cached=1; cached>=0; cached-- )
+        {
+            gdf::ConcurrentReader cr;
+            cr.open( reffile );
+            cr.enableCache( cached != 0 );
+            cr.setMaxCacheRecords( 20 );
+
+            cout << "Reading from " << num_threads << " threads, cache " << ( cached ? "enabled" : "disabled" ) << " .... ";
+            bool ok[num_threads];
+            boost::thread_group threads;
+            for( size_t i=0; i<num_threads; i++ )
+            {
+                ok[i] = false;
+                threads.create_thread( boost::bind( worker, &cr, &reference, i, &ok[i] ) );
+            }
+            threads.join_all( );
+
+            for( size_t i=0; i<num_threads; i++ )
+                if( !ok[i] )
+                    throw(std::invalid_argument("ERROR -- Signals differ."));
+            if( cr.getNumCachedRecords( ) > 20 )
+                throw(std::invalid_argument("ERROR -- Cache limit exceeded."));
+            if( cached )
+            {
+                // a limit smaller than the number of shards must hold as well
+                std::vector< std::vector< double > > all;
+                cr.setMaxCacheRecords( 1 );
+                cr.getSignals( all );
+                if( cr.getNumCachedRecords( ) != 1 )
+                    throw(std::invalid_argument("ERROR -- Cache limit of one record not respected."));
+                cr.setMaxCacheRecords( 20 );
+            }
+            cout << "OK" << endl;
+
+            cout << "Reading past the end .... ";
+            double duration = reference[0].size( ) / cr.getSignalHeader_readonly( 0 ).get_samplerate( );
+            std::vector< std::vector< double > > empty;
+            cr.getSignals( empty, duration + 10 );
+            for( size_t ch=0; ch<empty.size(); ch++ )
+                if( empty[ch].size( ) != 0 )
+                    throw(std::invalid_argument("ERROR -- Samples returned past the end."));
+            cr.getSignals( empty, duration + 10, duration + 20 );
+            for( size_t ch=0; ch<empty.size(); ch++ )
+                if( empty[ch].size( ) != 0 )
+                    throw(std::invalid_argument("ERROR -- Samples returned past the end."));
+            std::vector<double> tail( 5, 0 );
+            cr.getSignal( 0, &tail[0], reference[0].size( ) - 2, reference[0].size( ) + 3 );
+            if( !same( tail[0], reference[0][reference[0].size( ) - 2] ) || !same( tail[1], reference[0].back( ) ) || tail[2] != 0 )
+                throw(std::invalid_argument("ERROR -- Clamped single channel read differs."));
+            if( cr.getSample( 0, reference[0].size( ) - 1 ) != reference[0].back( ) )
+                throw(std::invalid_argument("ERROR -- Last sample differs."));
+            thrown = false;
+            try {
+                cr.getSample( 0, reference[0].size( ) );
+            } catch( gdf::exception::index_out_of_range & ) {
+                thrown = true;
+            }
+            if( !thrown )
+                throw(std::invalid_argument("ERROR -- Sample past the end was accepted."));
+            cout << "OK" << endl;
+
+            cout << "Comparing events .... ";
+            if( cr.getEventHeader( )->getNumEvents( ) != num_events )
+                throw(std::invalid_argument("ERROR -- Events differ."));
+            cout << "OK" << endl;
+
+            cr.close( );
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
@@ -0,0 +1,167 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include <GDF/Channel.h>
+#include <GDF/Conversion.h>
+#include <GDF/Exceptions.h>
+#include <GDF/SignalHeader.h>
+#include <GDF/Types.h>
+
+#include <iostream>
+#include <limits>
+#include <math.h>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+const size_t N = 37;    // not a multiple of any vector width
+const double scale = 0.125;
+const double offset = -3.5;
+
+/// Raw test values of type T, including both ends of the type's range
+template<typename T> std::vector<T> makeRaw( )
+{
+    std::vector<T> raw( N );
+    raw[0] = std::numeric_limits<T>::is_integer ? std::numeric_limits<T>::min( ) : -std::numeric_limits<T>::max( );
+    raw[1] = std::numeric_limits<T>::max( );
+    for( size_t i=2; i<N; i++ )
+        raw[i] = static_cast<T>( ( i * 37 ) % 101 ) - static_cast<T>( std::numeric_limits<T>::is_signed ? 50 : 0 );
+    return raw;
+}
+
+template<typename U> bool same( U a, double expected )
+{
+    return a == static_cast<U>( expected );
+}
+
+/// Check the typed, file representation and dispatching kernels for raw type T and physical type U
+template<typename T, typename U> void checkKernels( gdf::uint32 datatype )
+{
+    std::vector<T> raw = makeRaw<T>( );
+    std::ostringstream stream;
+    for( size_t i=0; i<N; i++ )
+        gdf::writeLittleEndian( stream, raw[i] );
+    const std::string file = stream.str( );
+
+    for( size_t stride=1; stride<=3; stride++ )
+    {
+        const U guard = static_cast<U>( 12345 );
+        std::vector<U> typed( N * stride, guard ), fromfile( N * stride, guard ), dispatched( N * stride, guard );
+        gdf::convertRawToPhys( &raw[0], &typed[0], N, scale, offset, stride );
+        gdf::convertRawToPhys<T>( &file[0], &fromfile[0], N, scale, offset, stride );
+        gdf::convertRawToPhys( datatype, &file[0], &dispatched[0], N, scale, offset, stride );
+
+        for( size_t i=0; i<N*stride; i++ )
+        {
+            if( i % stride != 0 )
+            {
+                if( typed[i] != guard || fromfile[i] != guard || dispatched[i] != guard )
+                    throw(std::invalid_argument("ERROR -- Kernel wrote between strided samples."));
+                continue;
+            }
+            double expected = static_cast<double>( raw[i/stride] ) * scale + offset;
+            if( !same( typed[i], expected ) || !same( fromfile[i], expected ) || !same( dispatched[i], expected ) )
+                throw(std::invalid_argument("ERROR -- Converted sample differs."));
+        }
+
+        std::vector<T> copied( N * stride, 0 );
+        gdf::copyRawSamples( &file[0], &copied[0], N, stride );
+        for( size_t i=0; i<N; i++ )
+            if( copied[i*stride] != raw[i] )
+                throw(std::invalid_argument("ERROR -- Copied raw sample differs."));
+    }
+}
+
+/// Check Channel::deblitSamplesPhys against per sample getSamplePhys for raw type T
+template<typename T> void checkChannel( gdf::uint32 datatype )
+{
+    gdf::SignalHeader sh;
+    sh.set_datatype( datatype );
+    sh.set_physmin( -250 );
+    sh.set_physmax( 250 );
+    sh.set_digmin( -100 );
+    sh.set_digmax( 100 );
+
+    std::vector<T> raw = makeRaw<T>( );
+    gdf::Channel c( &sh, N );
+    c.blitSamplesRaw( &raw[0], N );
+
+    const size_t start = 3, num = N - 5, stride = 2;
+    std::vector<double> d( num * stride, -1 );
+    std::vector<float> f( num * stride, -1 );
+    c.deblitSamplesPhys( &d[0], start, num, stride );
+    c.deblitSamplesPhys( &f[0], start, num, stride );
+    for( size_t i=0; i<num; i++ )
+    {
+        double expected = c.getSamplePhys( start + i );
+        if( d[i*stride] != expected || f[i*stride] != static_cast<float>( expected ) )
+            throw(std::invalid_argument("ERROR -- Channel deblit differs from getSamplePhys."));
+        if( d[i*stride+1] != -1 || f[i*stride+1] != -1 )
+            throw(std::invalid_argument("ERROR -- Channel deblit wrote between strided samples."));
+    }
+}
+
+template<typename T> void check( gdf::uint32 datatype, const char *name )
+{
+    cout << "Checking " << name << " .... ";
+    checkKernels<T, double>( datatype );
+    checkKernels<T, float>( datatype );
+    checkChannel<T>( datatype );
+    cout << "OK" << endl;
+}
+
+int main( )
+{
+    try
+    {
+        check<gdf::int8>( gdf::INT8, "int8" );
+        check<gdf::uint8>( gdf::UINT8, "uint8" );
+        check<gdf::int16>( gdf::INT16, "int16" );
+        check<gdf::uint16>( gdf::UINT16, "uint16" );
+        check<gdf::int32>( gdf::INT32, "int32" );
+        check<gdf::uint32>( gdf::UINT32, "uint32" );
+        check<gdf::int64>( gdf::INT64, "int64" );
+        check<gdf::uint64>( gdf::UINT64, "uint64" );
+        check<gdf::float32>( gdf::FLOAT32, "float32" );
+        check<gdf::float64>( gdf::FLOAT64, "float64" );
+
+        cout << "Checking invalid type .... ";
+        char dummy[8] = { 0 };
+        double out;
+        try
+        {
+            gdf::convertRawToPhys( 12345, dummy, &out, 1, scale, offset );
+            throw(std::invalid_argument("ERROR -- Invalid type was accepted."));
+        }
+        catch( gdf::exception::invalid_type_id & ) { }
+        cout << "OK" << endl;
+
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
@@ -0,0 +1,213 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/DataSource.h>
+#include <GDF/Reader.h>
+#include <GDF/Writer.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+const string annotfile = string(GDF_SOURCE_ROOT)+"/sampledata/Header3Tag1.gdf";
+const string testfile = "testdatasource.gdf.tmp";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+vector<char> readFile( const string &filename )
+{
+    ifstream in( filename.c_str(), ios_base::in | ios_base::binary );
+    return vector<char>( ( istreambuf_iterator<char>( in ) ), istreambuf_iterator<char>( ) );
+}
+
+void compareSignals( gdf::Reader &a, gdf::Reader &b )
+{
+    std::vector< std::vector< double > > buf_a, buf_b;
+    a.getSignals( buf_a );
+    b.getSignals( buf_b );
+    if( buf_a.size( ) != buf_b.size( ) )
+        throw(std::invalid_argument("ERROR -- Wrong number of channels."));
+    for( size_t ch=0; ch<buf_a.size(); ch++ )
+    {
+        if( buf_a[ch].size( ) != buf_b[ch].size( ) )
+            throw(std::invalid_argument("ERROR -- Wrong number of samples."));
+        for( size_t n=0; n<buf_a[ch].size(); n++ )
+            if( !same( buf_a[ch][n], buf_b[ch][n] ) )
+                throw(std::invalid_argument("ERROR -- Signals differ."));
+    }
+}
+
+void compareEvents( gdf::Reader &a, gdf::Reader &b )
+{
+    gdf::EventHeader *ea = a.getEventHeader( );
+    gdf::EventHeader *eb = b.getEventHeader( );
+    if( ea->getMode( ) != eb->getMode( ) || ea->getNumEvents( ) != eb->getNumEvents( ) )
+        throw(std::invalid_argument("ERROR -- Event headers differ."));
+    const gdf::EventTableView &va = a.getEventTableView( );
+    const gdf::EventTableView &vb = b.getEventTableView( );
+    if( va.getNumEvents( ) != ea->getNumEvents( ) || vb.getNumEvents( ) != ea->getNumEvents( ) )
+        throw(std::invalid_argument("ERROR -- Event table views differ."));
+    for( gdf::uint32 i=0; i<va.getNumEvents( ); i++ )
+        if( va.positions( )[i] != vb.positions( )[i] || va.types( )[i] != vb.types( )[i] )
+            throw(std::invalid_argument("ERROR -- Events differ."));
+}
+
+void copyHeader( gdf::Reader &r, gdf::Writer &w )
+{
+    w.getMainHeader( ).copyFrom( r.getMainHeader_readonly() );
+    w.getHeaderAccess().setRecordDuration( r.getMainHeader_readonly().get_datarecord_duration( 0 ), r.getMainHeader_readonly().get_datarecord_duration( 1 ) );
+    for( size_t m=0; m<w.getMainHeader_readonly().get_num_signals(); m++ )
+    {
+        w.createSignal( m, true );
+        w.getSignalHeader( m ).copyFrom( r.getSignalHeader_readonly( m ) );
+    }
+}
+
+void copyRecords( gdf::Reader &r, gdf::Writer &w )
+{
+    size_t num_recs = boost::numeric_cast<size_t>( r.getMainHeader_readonly( ).get_num_datarecords( ) );
+    for( size_t n=0; n<num_recs; n++ )
+    {
+        gdf::Record *rec = w.acquireRecord( );
+        r.readRecord( n, rec );
+        w.addRecord( rec );
+    }
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+    infilelist.push_back(annotfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+            cout << "Opening '" << reffile << "' for reading." << endl;
+
+            gdf::Reader r_file;
+            r_file.open( reffile );
+
+            cout << "Reading from memory .... ";
+            vector<char> bytes = readFile( reffile );
+            gdf::MemorySource memory( &bytes[0], bytes.size( ) );
+            gdf::Reader r_memory;
+            r_memory.open( memory );
+            if( !r_memory.isMemoryMapped( ) )
+                throw(std::invalid_argument("ERROR -- Memory source is not decoded in place."));
+            compareSignals( r_file, r_memory );
+            compareEvents( r_file, r_memory );
+            r_memory.close( );
+            cout << "OK" << endl;
+
+            cout << "Reading from pipe .... ";
+            istringstream stream( string( bytes.begin( ), bytes.end( ) ) );
+            gdf::PipeSource pipe( stream );
+            gdf::Reader r_pipe;
+            r_pipe.open( pipe );
+            if( r_pipe.isMemoryMapped( ) )
+                throw(std::invalid_argument("ERROR -- Pipe source claims to be in memory."));
+            compareSignals( r_file, r_pipe );
+            compareEvents( r_file, r_pipe );
+            r_pipe.close( );
+            cout << "OK" << endl;
+
+            r_file.close( );
+        }
+
+        gdf::Reader r;
+        r.open( alltypesfile );
+
+        cout << "Writing to file and memory .... ";
+        gdf::Writer w_file;
+        copyHeader( r, w_file );
+        w_file.open( testfile, gdf::writer_ev_memory | gdf::writer_overwrite );
+        copyRecords( r, w_file );
+        w_file.close( );
+        vector<char> file_bytes = readFile( testfile );
+
+        gdf::MemorySink memsink;
+        gdf::Writer w_memory;
+        copyHeader( r, w_memory );
+        w_memory.open( memsink );
+        copyRecords( r, w_memory );
+        w_memory.close( );
+        if( memsink.getBuffer( ) != file_bytes )
+            throw(std::invalid_argument("ERROR -- Memory sink differs from file."));
+
+        vector<char> written;
+        memsink.takeBuffer( written );
+        gdf::MemorySource memsource( written );
+        gdf::Reader r_written;
+        r_written.open( memsource );
+        compareSignals( r, r_written );
+        r_written.close( );
+        cout << "OK" << endl;
+
+        cout << "Writing to pipe .... ";
+        ostringstream out;
+        gdf::PipeSink pipesink( out );
+        gdf::Writer w_pipe;
+        copyHeader( r, w_pipe );
+        w_pipe.open( pipesink );
+        copyRecords( r, w_pipe );
+        w_pipe.close( );
+        string piped = out.str( );
+        if( piped.size( ) != file_bytes.size( ) )
+            throw(std::invalid_argument("ERROR -- Pipe sink has wrong size."));
+        // the number of records is not known when the header passes through the pipe
+        gdf::int64 num_recs;
+        gdf::readLittleEndian( piped.data( ) + 236, num_recs );
+        if( num_recs != -1 )
+            throw(std::invalid_argument("ERROR -- Pipe sink should leave number of records unknown."));
+        for( size_t i=0; i<piped.size( ); i++ )
+            if( ( i < 236 || i >= 244 ) && piped[i] != file_bytes[i] )
+                throw(std::invalid_argument("ERROR -- Pipe sink differs from file."));
+        cout << "OK" << endl;
+
+        r.close( );
+        remove( testfile.c_str() );
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
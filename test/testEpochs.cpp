@@ -0,0 +1,121 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <limits>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+// compares epochs against the complete signals; the event table of the test file uses the signal sampling rate
+void checkEpochs( const std::vector<double> &epochs, size_t S, const std::vector<gdf::uint32> &positions, size_t pre,
+                  const std::vector<gdf::uint16> &channels, const std::vector< std::vector< double > > &ref )
+{
+    size_t C = channels.size( );
+    if( epochs.size( ) != positions.size( ) * C * S )
+        throw(std::invalid_argument("ERROR -- Wrong epoch buffer size."));
+    for( size_t e=0; e<positions.size(); e++ )
+        for( size_t i=0; i<C; i++ )
+            for( size_t s=0; s<S; s++ )
+            {
+                // event positions are one-based
+                long n = long( positions[e] ) - 1 - long( pre ) + long( s );
+                const std::vector<double> &sig = ref[channels[i]];
+                double expected = ( n < 0 || n >= long( sig.size( ) ) ) ? std::numeric_limits<double>::quiet_NaN( ) : sig[n];
+                if( !same( epochs[( e*C + i )*S + s], expected ) )
+                    throw(std::invalid_argument("ERROR -- Epoch samples differ."));
+            }
+}
+
+int main( )
+{
+    try
+    {
+        for( int mode=0; mode<3; mode++ )
+        {
+            gdf::Reader r;
+            cout << "Opening '" << reffile << "' for reading." << endl;
+            r.open( reffile, mode == 2 ? gdf::reader_mmap : gdf::reader_default );
+            if( mode == 1 )
+                r.enableCache( false );
+
+            std::vector< std::vector< double > > ref;
+            r.getSignals( ref );
+            double fs = r.getSignalHeader_readonly( 0 ).get_samplerate( );
+
+            std::vector<gdf::uint16> channels;
+            channels.push_back( 2 );
+            channels.push_back( 0 );
+
+            cout << "Comparing overlapping and clipped epochs (mode " << mode << ") .... ";
+            std::vector<gdf::uint32> positions;
+            positions.push_back( 1500 );
+            positions.push_back( 10 );      // starts before the recording
+            positions.push_back( 1510 );    // overlaps the first epoch
+            positions.push_back( boost::numeric_cast<gdf::uint32>( ref[0].size( ) - 20 ) ); // ends after the recording
+            positions.push_back( 1500 );
+            std::vector<double> epochs;
+            size_t S = r.getEpochs( epochs, positions, 64 / fs, 256 / fs, channels );
+            if( S != 320 )
+                throw(std::invalid_argument("ERROR -- Wrong epoch length."));
+            checkEpochs( epochs, S, positions, 64, channels, ref );
+            cout << "OK" << endl;
+
+            cout << "Comparing epochs of an event type .... ";
+            std::vector<gdf::Mode1Event> events = r.getEventHeader( )->getMode1Events( );
+            positions.clear( );
+            for( size_t i=0; i<events.size(); i++ )
+                if( events[i].type == 768 )
+                    positions.push_back( events[i].position );
+            if( positions.empty( ) )
+                throw(std::invalid_argument("ERROR -- Test file has no events of type 768."));
+            S = r.getEpochs( epochs, 768, 0.5, 2.0 );
+            std::vector<gdf::uint16> all;
+            for( gdf::uint16 ch=0; ch<ref.size(); ch++ )
+                all.push_back( ch );
+            checkEpochs( epochs, S, positions, 64, all, ref );
+            cout << "OK" << endl;
+
+            r.close( );
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
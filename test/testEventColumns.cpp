@@ -0,0 +1,119 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/EventHeader.h>
+
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+
+using namespace std;
+
+const size_t NUM_EVENTS = 1000000;
+
+int main( )
+{
+    try
+    {
+        cout << "Round trip of " << NUM_EVENTS << " mode 1 events .... ";
+        gdf::EventHeader eh1;
+        eh1.setSamplingRate( 256 );
+        gdf::EventColumns c1;
+        for( size_t i=0; i<NUM_EVENTS; i++ )
+        {
+            c1.position.push_back( gdf::uint32( i * 3 + 1 ) );
+            c1.type.push_back( gdf::uint16( i % 1000 ) );
+        }
+        eh1.setColumns( c1 );
+        std::stringstream ss1;
+        eh1.toStream( ss1 );
+        gdf::EventHeader in1;
+        in1.fromStream( ss1 );
+        if( in1.getMode( ) != 1 || in1.getNumEvents( ) != NUM_EVENTS || in1.getSamplingRate( ) != 256 )
+            throw(std::invalid_argument("ERROR -- Mode 1 header differs."));
+        const std::vector<gdf::Mode1Event> &ev1 = in1.getMode1Events_readonly( );
+        for( size_t i=0; i<NUM_EVENTS; i++ )
+            if( ev1[i].position != c1.position[i] || ev1[i].type != c1.type[i] )
+                throw(std::invalid_argument("ERROR -- Mode 1 events differ."));
+        cout << "OK" << endl;
+
+        cout << "Round trip of " << NUM_EVENTS << " mode 3 events .... ";
+        gdf::EventHeader eh3;
+        eh3.setMode( 3 );
+        eh3.setSamplingRate( 1000 );
+        gdf::Mode3Event e;
+        for( size_t i=0; i<NUM_EVENTS; i++ )
+        {
+            e.position = gdf::uint32( i + 1 );
+            e.type = gdf::uint16( i % 7 == 0 ? 0x7fff : i % 13 );
+            e.channel = gdf::uint16( i % 5 );
+            if( e.type == 0x7fff )
+                e.value = gdf::float32( i ) * 0.5f;
+            else
+                e.duration = gdf::uint32( i * 11 );
+            eh3.addEvent( e );
+        }
+        std::stringstream ss3;
+        eh3.toStream( ss3 );
+        gdf::EventHeader in3;
+        in3.fromStream( ss3 );
+        if( in3.getMode( ) != 3 || in3.getNumEvents( ) != NUM_EVENTS )
+            throw(std::invalid_argument("ERROR -- Mode 3 header differs."));
+        const std::vector<gdf::Mode3Event> &a = eh3.getMode3Events_readonly( );
+        const std::vector<gdf::Mode3Event> &b = in3.getMode3Events_readonly( );
+        for( size_t i=0; i<NUM_EVENTS; i++ )
+            if( a[i].position != b[i].position || a[i].type != b[i].type || a[i].channel != b[i].channel || a[i].duration != b[i].duration )
+                throw(std::invalid_argument("ERROR -- Mode 3 events differ."));
+        if( ss3.str( ).size( ) != 8 + NUM_EVENTS * 12 )
+            throw(std::invalid_argument("ERROR -- Wrong event table size."));
+        cout << "OK" << endl;
+
+        cout << "Columns of mode 3 events .... ";
+        gdf::EventColumns c3;
+        in3.getColumns( c3 );
+        if( c3.position.size( ) != NUM_EVENTS || c3.channel.size( ) != NUM_EVENTS || c3.duration[14] != a[14].duration )
+            throw(std::invalid_argument("ERROR -- Columns differ."));
+        c3.channel.pop_back( );
+        bool thrown = false;
+        try
+        {
+            in3.setColumns( c3 );
+        }
+        catch( gdf::exception::invalid_operation & )
+        {
+            thrown = true;
+        }
+        if( !thrown || in3.getNumEvents( ) != NUM_EVENTS )
+            throw(std::invalid_argument("ERROR -- Inconsistent columns accepted."));
+        cout << "OK" << endl;
+
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
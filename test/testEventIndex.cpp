@@ -0,0 +1,156 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/EventHeader.h>
+#include <GDF/Reader.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string neqsfile = string(GDF_SOURCE_ROOT)+"/sampledata/NEQSuint32Ch678.GDF";
+
+// brute force reference for EventHeader::getChannelEvents; channel 0 means any channel
+std::vector<gdf::uint32> scan( const std::vector<gdf::Mode3Event> &ev, gdf::uint16 type, gdf::uint16 channel, gdf::uint32 begin, gdf::uint32 end )
+{
+    std::vector<gdf::uint32> result;
+    for( gdf::uint32 pos=begin; pos<end; pos++ )
+        for( size_t i=0; i<ev.size(); i++ )
+            if( ev[i].position == pos && ev[i].type == type && ( channel == 0 || ev[i].channel == channel ) )
+                result.push_back( boost::numeric_cast<gdf::uint32>( i ) );
+    return result;
+}
+
+bool equal( const gdf::EventRange &range, const std::vector<gdf::uint32> &ref )
+{
+    return range.size( ) == ref.size( ) && std::equal( range.begin( ), range.end( ), ref.begin( ) );
+}
+
+int main( )
+{
+    try
+    {
+        cout << "Querying unsorted mode 3 events .... ";
+        gdf::EventHeader eh;
+        eh.setMode( 3 );
+        srand( 42 );
+        for( size_t i=0; i<2000; i++ )
+        {
+            gdf::Mode3Event e;
+            e.position = rand( ) % 500 + 1;
+            e.type = ( rand( ) % 2 ) ? 0x7fff : boost::numeric_cast<gdf::uint16>( rand( ) % 4 + 1 );
+            e.channel = boost::numeric_cast<gdf::uint16>( rand( ) % 3 + 1 );
+            e.duration = 0;
+            eh.addEvent( e );
+        }
+        const std::vector<gdf::Mode3Event> &ev = eh.getMode3Events_readonly( );
+        for( gdf::uint16 type=1; type<=4; type++ )
+        {
+            if( !equal( eh.getEvents( type ), scan( ev, type, 0, 0, 501 ) ) )
+                throw(std::invalid_argument("ERROR -- getEvents differs."));
+            if( !equal( eh.getEvents( type, 100, 250 ), scan( ev, type, 0, 100, 250 ) ) )
+                throw(std::invalid_argument("ERROR -- getEvents range differs."));
+            if( !eh.getEvents( type, 250, 100 ).empty( ) )
+                throw(std::invalid_argument("ERROR -- Empty range not empty."));
+        }
+        for( gdf::uint16 ch=1; ch<=3; ch++ )
+        {
+            if( !equal( eh.getSparseSampleRange( ch ), scan( ev, 0x7fff, ch, 0, 501 ) ) )
+                throw(std::invalid_argument("ERROR -- getSparseSampleRange differs."));
+            if( !equal( eh.getChannelEvents( 2, ch, 17, 400 ), scan( ev, 2, ch, 17, 400 ) ) )
+                throw(std::invalid_argument("ERROR -- getChannelEvents differs."));
+        }
+        if( !eh.getEvents( 99 ).empty( ) || !eh.getSparseSampleRange( 4 ).empty( ) )
+            throw(std::invalid_argument("ERROR -- Nonexistent type found."));
+        cout << "OK" << endl;
+
+        cout << "Updating index after modification .... ";
+        size_t before = eh.getEvents( 3 ).size( );
+        gdf::Mode3Event e;
+        e.position = 1000;
+        e.type = 3;
+        e.channel = 1;
+        e.duration = 0;
+        eh.addEvent( e );
+        if( eh.getEvents( 3 ).size( ) != before + 1 || eh.getEvents( 3, 1000, 1001 ).size( ) != 1 )
+            throw(std::invalid_argument("ERROR -- Index not updated after addEvent."));
+        eh.sort( );
+        if( !equal( eh.getEvents( 3 ), scan( eh.getMode3Events_readonly( ), 3, 0, 0, 1001 ) ) )
+            throw(std::invalid_argument("ERROR -- Index not updated after sort."));
+        eh.clear( );
+        if( !eh.getEvents( 3 ).empty( ) )
+            throw(std::invalid_argument("ERROR -- Index not updated after clear."));
+        cout << "OK" << endl;
+
+        cout << "Querying mode 1 events .... ";
+        gdf::EventHeader eh1;
+        gdf::Mode1Event e1;
+        for( gdf::uint32 i=0; i<100; i++ )
+        {
+            e1.position = ( i * 37 ) % 101 + 1;
+            e1.type = boost::numeric_cast<gdf::uint16>( i % 3 );
+            eh1.addEvent( e1 );
+        }
+        gdf::EventRange r1 = eh1.getEvents( 1, 10, 60 );
+        for( size_t i=0; i<r1.size(); i++ )
+        {
+            const gdf::Mode1Event &m = eh1.getMode1Events_readonly( )[r1[i]];
+            if( m.type != 1 || m.position < 10 || m.position >= 60 || ( i > 0 && eh1.getMode1Events_readonly( )[r1[i-1]].position > m.position ) )
+                throw(std::invalid_argument("ERROR -- Mode 1 query wrong."));
+        }
+        if( !eh1.getChannelEvents( 1, 1 ).empty( ) )
+            throw(std::invalid_argument("ERROR -- Mode 1 channel query not empty."));
+        cout << "OK" << endl;
+
+        cout << "Comparing sparse samples of '" << neqsfile << "' .... ";
+        gdf::Reader r;
+        r.open( neqsfile );
+        gdf::EventHeader *feh = r.getEventHeader( );
+        for( gdf::uint16 ch=1; ch<=r.getMainHeader_readonly( ).get_num_signals( ); ch++ )
+        {
+            std::vector<gdf::uint32> ref;
+            const std::vector<gdf::Mode3Event> &fev = feh->getMode3Events_readonly( );
+            for( size_t i=0; i<fev.size(); i++ )
+                if( fev[i].channel == ch && fev[i].type == 0x7fff )
+                    ref.push_back( boost::numeric_cast<gdf::uint32>( i ) );
+            if( feh->getSparseSamples( ch ) != ref )
+                throw(std::invalid_argument("ERROR -- getSparseSamples differs."));
+        }
+        r.close( );
+        cout << "OK" << endl;
+
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
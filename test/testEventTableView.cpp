@@ -0,0 +1,105 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+const string annotfile = string(GDF_SOURCE_ROOT)+"/sampledata/Header3Tag1.gdf";
+const string neqsfile = string(GDF_SOURCE_ROOT)+"/sampledata/NEQSuint32Ch678.GDF";
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+    infilelist.push_back(annotfile);
+    infilelist.push_back(neqsfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            gdf::Reader r;
+            cout << "Opening '" << reffile << "' for reading." << endl;
+            r.open( reffile );
+
+            cout << "Comparing event table view .... ";
+            const gdf::EventTableView &view = r.getEventTableView( );
+            gdf::EventHeader *eh = r.getEventHeader( );
+            if( view.getNumEvents( ) != eh->getNumEvents( ) || view.getSamplingRate( ) != eh->getSamplingRate( ) )
+                throw(std::invalid_argument("ERROR -- Event table header differs."));
+            if( view.getNumEvents( ) > 0 && view.getMode( ) != eh->getMode( ) )
+                throw(std::invalid_argument("ERROR -- Event mode differs."));
+            if( view.positions( ).size( ) != view.getNumEvents( ) || view.types( ).size( ) != view.getNumEvents( ) )
+                throw(std::invalid_argument("ERROR -- Wrong column size."));
+
+            for( gdf::uint32 i=0; i<view.getNumEvents( ); i++ )
+            {
+                if( view.getMode( ) == 1 )
+                {
+                    gdf::Mode1Event a, b;
+                    view.getEvent( i, a );
+                    eh->getEvent( i, b );
+                    if( a.position != b.position || a.type != b.type || view.positions( )[i] != b.position )
+                        throw(std::invalid_argument("ERROR -- Mode 1 events differ."));
+                }
+                else
+                {
+                    gdf::Mode3Event a, b;
+                    view.getEvent( i, a );
+                    eh->getEvent( i, b );
+                    if( a.position != b.position || a.type != b.type || a.channel != b.channel || a.duration != b.duration
+                        || view.channels( )[i] != b.channel || view.durations( )[i] != b.duration )
+                        throw(std::invalid_argument("ERROR -- Mode 3 events differ."));
+                }
+            }
+
+            if( view.getNumEvents( ) > 1 )
+            {
+                std::vector<gdf::uint16> types( 2 );
+                view.types( ).copy( &types[0], view.getNumEvents( ) - 2, 2 );
+                if( types[1] != view.types( )[view.getNumEvents( ) - 1] )
+                    throw(std::invalid_argument("ERROR -- Column copy differs."));
+            }
+            cout << "OK" << endl;
+
+            r.close( );
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
@@ -0,0 +1,110 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/GDFHeaderAccess.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string.h>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+const string annotfile = string(GDF_SOURCE_ROOT)+"/sampledata/Header3Tag1.gdf";
+const string neqsfile = string(GDF_SOURCE_ROOT)+"/sampledata/NEQSuint32Ch678.GDF";
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+    infilelist.push_back(annotfile);
+    infilelist.push_back(neqsfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            cout << "Reading header of '" << reffile << "' .... ";
+            ifstream in( reffile.c_str( ), ios_base::in | ios_base::binary );
+            gdf::GDFHeaderAccess hdr;
+            in >> hdr;
+            cout << "OK" << endl;
+
+            cout << "Comparing serialized fixed and signal headers .... ";
+            size_t ns = hdr.getMainHeader_readonly( ).get_num_signals( );
+            size_t len = 256 * ( 1 + ns );
+            std::vector<char> original( len );
+            in.seekg( 0 );
+            in.read( &original[0], len );
+
+            stringstream out;
+            out << hdr;
+            string written = out.str( );
+            if( written.size( ) < len || memcmp( written.data( ), &original[0], len ) != 0 )
+                throw(std::invalid_argument("ERROR -- Header differs after writing."));
+
+            gdf::GDFHeaderAccess hdr2;
+            out.seekg( 0 );
+            out >> hdr2;
+            for( size_t i=0; i<ns; i++ )
+            {
+                const gdf::SignalHeader &a = hdr.getSignalHeader_readonly( i );
+                const gdf::SignalHeader &b = hdr2.getSignalHeader_readonly( i );
+                if( a.get_label( ) != b.get_label( ) || a.get_physmin( ) != b.get_physmin( ) || a.get_digmax( ) != b.get_digmax( )
+                    || a.get_samples_per_record( ) != b.get_samples_per_record( ) || a.get_datatype( ) != b.get_datatype( )
+                    || a.get_sensor_pos( 2 ) != b.get_sensor_pos( 2 ) )
+                    throw(std::invalid_argument("ERROR -- Signal header differs after reading."));
+            }
+            cout << "OK" << endl;
+
+            cout << "Rejecting truncated header .... ";
+            stringstream truncated( string( &original[0], len - 1 ) );
+            gdf::GDFHeaderAccess hdr3;
+            bool thrown = false;
+            try
+            {
+                truncated >> hdr3;
+            }
+            catch( gdf::exception::serialization_error & )
+            {
+                thrown = true;
+            }
+            if( !thrown )
+                throw(std::invalid_argument("ERROR -- Truncated header accepted."));
+            cout << "OK" << endl;
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
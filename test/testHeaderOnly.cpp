@@ -0,0 +1,138 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+const string annotfile = string(GDF_SOURCE_ROOT)+"/sampledata/Header3Tag1.gdf";
+const string neqsfile = string(GDF_SOURCE_ROOT)+"/sampledata/NEQSuint32Ch678.GDF";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+void compareHeaders( const gdf::GDFHeaderAccess &a, const gdf::GDFHeaderAccess &b )
+{
+    const gdf::MainHeader &ma = a.getMainHeader_readonly( );
+    const gdf::MainHeader &mb = b.getMainHeader_readonly( );
+    if( ma.get_num_signals( ) != mb.get_num_signals( ) || ma.get_num_datarecords( ) != mb.get_num_datarecords( )
+        || ma.get_header_length( ) != mb.get_header_length( ) || ma.get_patient_id( ) != mb.get_patient_id( ) )
+        throw(std::invalid_argument("ERROR -- Main headers differ."));
+    for( size_t i=0; i<ma.get_num_signals( ); i++ )
+    {
+        const gdf::SignalHeader &sa = a.getSignalHeader_readonly( i );
+        const gdf::SignalHeader &sb = b.getSignalHeader_readonly( i );
+        if( sa.get_label( ) != sb.get_label( ) || sa.get_samplerate( ) != sb.get_samplerate( )
+            || sa.get_samples_per_record( ) != sb.get_samples_per_record( ) || sa.get_datatype( ) != sb.get_datatype( ) )
+            throw(std::invalid_argument("ERROR -- Signal headers differ."));
+    }
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+    infilelist.push_back(annotfile);
+    infilelist.push_back(neqsfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            gdf::Reader r;
+            cout << "Opening '" << reffile << "' for reading." << endl;
+            r.open( reffile );
+
+            cout << "Peeking header .... ";
+            gdf::GDFHeaderAccess peeked;
+            gdf::Reader::peekHeader( reffile, peeked );
+            compareHeaders( peeked, r.getHeaderAccess_readonly( ) );
+            cout << "OK" << endl;
+
+            cout << "Opening header only .... ";
+            gdf::Reader h;
+            h.openHeaderOnly( reffile );
+            compareHeaders( h.getHeaderAccess_readonly( ), r.getHeaderAccess_readonly( ) );
+            if( h.getNumCachedRecords( ) != 0 )
+                throw(std::invalid_argument("ERROR -- Records cached after header only open."));
+            if( h.getEventHeader( )->getNumEvents( ) != r.getEventHeader( )->getNumEvents( ) )
+                throw(std::invalid_argument("ERROR -- Events differ."));
+            cout << "OK" << endl;
+
+            cout << "Reading data after header only open .... ";
+            std::vector< std::vector< double > > buf_full, buf_header;
+            r.getSignals( buf_full );
+            h.getSignals( buf_header );
+            if( buf_full.size( ) != buf_header.size( ) )
+                throw(std::invalid_argument("ERROR -- Wrong number of channels."));
+            for( size_t ch=0; ch<buf_full.size(); ch++ )
+            {
+                if( buf_full[ch].size( ) != buf_header[ch].size( ) )
+                    throw(std::invalid_argument("ERROR -- Wrong number of samples."));
+                for( size_t n=0; n<buf_full[ch].size(); n++ )
+                    if( !same( buf_full[ch][n], buf_header[ch][n] ) )
+                        throw(std::invalid_argument("ERROR -- Signals differ."));
+            }
+            cout << "OK" << endl;
+
+            cout << "Reading a record after header only open .... ";
+            gdf::Reader h2;
+            h2.openHeaderOnly( reffile );
+            size_t last = boost::numeric_cast<size_t>( r.getMainHeader_readonly( ).get_num_datarecords( ) ) - 1;
+            gdf::Record *a = r.getRecordPtr( last );
+            gdf::Record *b = h2.getRecordPtr( last );
+            for( size_t ch=0; ch<buf_full.size(); ch++ )
+            {
+                size_t spr = r.getSignalHeader_readonly( ch ).get_samples_per_record( );
+                for( size_t i=0; i<spr; i++ )
+                    if( !same( a->getChannel( ch )->getSamplePhys( i ), b->getChannel( ch )->getSamplePhys( i ) ) )
+                        throw(std::invalid_argument("ERROR -- Records differ."));
+            }
+            cout << "OK" << endl;
+
+            h2.close( );
+            h.close( );
+            r.close( );
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
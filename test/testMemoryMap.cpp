@@ -0,0 +1,127 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+const string annotfile = string(GDF_SOURCE_ROOT)+"/sampledata/Header3Tag1.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+    infilelist.push_back(annotfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            gdf::Reader r_stream, r_mmap;
+
+            cout << "Opening '" << reffile << "' for reading." << endl;
+            r_stream.open( reffile );
+            r_mmap.open( reffile, gdf::reader_mmap );
+
+            if( r_stream.isMemoryMapped( ) || !r_mmap.isMemoryMapped( ) )
+                throw(std::invalid_argument("ERROR -- Wrong reader mode."));
+
+            cout << "Comparing signals .... ";
+            std::vector< std::vector< double > > buf_stream, buf_mmap;
+            r_stream.getSignals( buf_stream );
+            r_mmap.getSignals( buf_mmap );
+
+            if( buf_stream.size( ) != buf_mmap.size( ) )
+                throw(std::invalid_argument("ERROR -- Wrong number of channels."));
+
+            for( size_t ch=0; ch<buf_stream.size(); ch++ )
+            {
+                if( buf_stream[ch].size( ) != buf_mmap[ch].size( ) )
+                    throw(std::invalid_argument("ERROR -- Wrong number of samples."));
+                for( size_t n=0; n<buf_stream[ch].size(); n++ )
+                    if( !same( buf_stream[ch][n], buf_mmap[ch][n] ) )
+                        throw(std::invalid_argument("ERROR -- Signals differ."));
+            }
+            cout << "OK" << endl;
+
+            cout << "Comparing single channels and samples .... ";
+            for( size_t ch=0; ch<buf_stream.size(); ch++ )
+            {
+                size_t N = buf_stream[ch].size( );
+                if( N < 3 )
+                    continue;
+                std::vector<double> single( N/2 );
+                r_mmap.getSignal( boost::numeric_cast<gdf::uint16>( ch ), &single[0], N/3, N/3 + single.size( ) );
+                for( size_t n=0; n<single.size(); n++ )
+                    if( !same( single[n], buf_stream[ch][N/3+n] ) )
+                        throw(std::invalid_argument("ERROR -- getSignal differs."));
+
+                if( !same( r_mmap.getSample( boost::numeric_cast<gdf::uint16>( ch ), N-1 ), buf_stream[ch][N-1] ) )
+                    throw(std::invalid_argument("ERROR -- getSample differs."));
+            }
+            cout << "OK" << endl;
+
+            cout << "Comparing records .... ";
+            size_t num_recs = boost::numeric_cast<size_t>( r_stream.getMainHeader_readonly( ).get_num_datarecords( ) );
+            for( size_t n=0; n<num_recs; n++ )
+            {
+                gdf::Record *a = r_stream.getRecordPtr( n );
+                gdf::Record *b = r_mmap.getRecordPtr( n );
+                for( size_t ch=0; ch<buf_stream.size(); ch++ )
+                {
+                    size_t spr = r_stream.getSignalHeader_readonly( ch ).get_samples_per_record( );
+                    for( size_t i=0; i<spr; i++ )
+                        if( !same( a->getChannel( ch )->getSamplePhys( i ), b->getChannel( ch )->getSamplePhys( i ) ) )
+                            throw(std::invalid_argument("ERROR -- Records differ."));
+                }
+            }
+            cout << "OK" << endl;
+
+            r_stream.close( );
+            r_mmap.close( );
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
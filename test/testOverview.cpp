@@ -0,0 +1,161 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Overview.h>
+#include <GDF/Reader.h>
+
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+const string testfile = "testoverview.ovr.tmp";
+
+bool close_to( double a, double b )
+{
+    return fabs( a - b ) <= 1e-5 * std::max( 1.0, fabs( b ) );
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            gdf::Reader r;
+            cout << "Opening '" << reffile << "' for reading." << endl;
+            r.open( reffile );
+
+            const size_t base = 4;
+            cout << "Building overview .... ";
+            gdf::Overview::build( r, testfile, base );
+            gdf::Overview ov;
+            ov.open( testfile );
+            cout << "OK" << endl;
+
+            std::vector< std::vector< double > > data;
+            r.getSignals( data );
+            if( ov.getNumChannels( ) != data.size( ) || ov.getBaseBinSize( ) != base )
+                throw(std::invalid_argument("ERROR -- Wrong overview header."));
+
+            cout << "Comparing bins with brute force .... ";
+            for( size_t ch=0; ch<data.size(); ch++ )
+            {
+                gdf::uint16 c = boost::numeric_cast<gdf::uint16>( ch );
+                size_t N = data[ch].size( );
+                if( ov.getNumSamples( c ) != N )
+                    throw(std::invalid_argument("ERROR -- Wrong number of samples."));
+                if( ov.getLevel( c, ov.getNumLevels( c ) - 1 ).size( ) != 1 )
+                    throw(std::invalid_argument("ERROR -- Top level must have a single bin."));
+
+                for( size_t k=0; k<ov.getNumLevels( c ); k++ )
+                {
+                    const std::vector<gdf::OverviewBin> &bins = ov.getLevel( c, k );
+                    size_t bs = ov.getBinSize( k );
+                    if( k > 0 && bins.size( ) != ( ov.getLevel( c, k-1 ).size( ) + 1 ) / 2 )
+                        throw(std::invalid_argument("ERROR -- Wrong number of bins."));
+                    for( size_t b=0; b<bins.size(); b++ )
+                    {
+                        size_t s0 = std::min( b*bs, N ), s1 = std::min( s0 + bs, N );
+                        double mn = data[ch][s0], mx = data[ch][s0], sum = 0;
+                        for( size_t n=s0; n<s1; n++ )
+                        {
+                            mn = std::min( mn, data[ch][n] );
+                            mx = std::max( mx, data[ch][n] );
+                            sum += data[ch][n];
+                        }
+                        if( !close_to( bins[b].min, mn ) || !close_to( bins[b].max, mx ) || !close_to( bins[b].mean, sum / ( s1 - s0 ) ) )
+                            throw(std::invalid_argument("ERROR -- Bin differs."));
+                    }
+                }
+            }
+            cout << "OK" << endl;
+
+            cout << "Checking level selection .... ";
+            gdf::uint16 c = 0;
+            size_t N = data[0].size( );
+            std::vector<gdf::OverviewBin> bins;
+            for( size_t pixels=1; pixels<=N; pixels*=2 )
+            {
+                size_t bs = ov.query( c, 0, N, pixels, bins );
+                size_t level = ov.selectLevel( c, N, pixels );
+                if( bs != ov.getBinSize( level ) || bins.size( ) != ov.getLevel( c, level ).size( ) )
+                    throw(std::invalid_argument("ERROR -- query does not match level."));
+                if( level > 0 && bins.size( ) < pixels )
+                    throw(std::invalid_argument("ERROR -- Too few bins for the requested width."));
+                if( level + 1 < ov.getNumLevels( c ) && ov.getBinSize( level + 1 ) * pixels <= N )
+                    throw(std::invalid_argument("ERROR -- A coarser level would suffice."));
+            }
+            if( N > 10*base )
+            {
+                ov.query( c, 3*base + 1, 7*base, 1000000, bins );
+                if( bins.size( ) != 4 || !close_to( bins[0].min, ov.getLevel( c, 0 )[3].min ) )
+                    throw(std::invalid_argument("ERROR -- Wrong bins for a sub range."));
+            }
+            cout << "OK" << endl;
+
+            r.close( );
+        }
+
+        cout << "Building overview to an unwritable path .... ";
+        {
+            gdf::Reader r;
+            r.open( reffile0 );
+            bool thrown = false;
+            try
+            {
+                gdf::Overview::build( r, "no/such/directory/overview.tmp", 4 );
+            }
+            catch( gdf::exception::serialization_error & )
+            {
+                thrown = true;
+            }
+            if( !thrown )
+                throw(std::invalid_argument("ERROR -- Unwritable path not reported."));
+        }
+        cout << "OK" << endl;
+
+        remove( testfile.c_str() );
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    remove( testfile.c_str() );
+    return 1;   // test failed
+}
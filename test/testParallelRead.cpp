@@ -0,0 +1,129 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+bool compare( const std::vector< std::vector< double > > &a, const std::vector< std::vector< double > > &b )
+{
+    if( a.size( ) != b.size( ) )
+        return false;
+    for( size_t ch=0; ch<a.size(); ch++ )
+    {
+        if( a[ch].size( ) != b[ch].size( ) )
+            return false;
+        for( size_t n=0; n<a[ch].size(); n++ )
+            if( !same( a[ch][n], b[ch][n] ) )
+                return false;
+    }
+    return true;
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            gdf::Reader r_serial;
+            cout << "Opening '" << reffile << "' for reading." << endl;
+            r_serial.open( reffile );
+
+            for( int flags=gdf::reader_default; flags<=gdf::reader_mmap; flags++ )
+            {
+                gdf::Reader r_par;
+                r_par.open( reffile, flags );
+                r_par.setNumThreads( 4 );
+
+                cout << "Comparing parallel signals" << ( flags ? " (mmap)" : "" ) << " .... ";
+                std::vector< std::vector< double > > buf_serial, buf_par;
+                r_serial.getSignals( buf_serial );
+                r_par.getSignals( buf_par );
+                if( !compare( buf_serial, buf_par ) )
+                    throw(std::invalid_argument("ERROR -- Parallel signals differ."));
+
+                // a window that does not start at a record boundary, with fewer records than threads
+                std::vector<gdf::uint16> channels;
+                channels.push_back( 0 );
+                channels.push_back( boost::numeric_cast<gdf::uint16>( buf_serial.size( ) - 1 ) );
+                double fs = r_serial.getSignalHeader_readonly( 0 ).get_samplerate( );
+                r_serial.getSignals( buf_serial, 1.5 / fs, 3.5 / fs, channels );
+                r_par.getSignals( buf_par, 1.5 / fs, 3.5 / fs, channels );
+                if( !compare( buf_serial, buf_par ) )
+                    throw(std::invalid_argument("ERROR -- Parallel window differs."));
+                cout << "OK" << endl;
+
+                cout << "Comparing parallel single channel .... ";
+                r_serial.getSignals( buf_serial );
+                size_t N = buf_serial[0].size( );
+                std::vector<double> single( N - N/3 );
+                r_par.getSignal( 0, &single[0], N/3, N );
+                for( size_t n=0; n<single.size(); n++ )
+                    if( !same( single[n], buf_serial[0][N/3+n] ) )
+                        throw(std::invalid_argument("ERROR -- Parallel getSignal differs."));
+                cout << "OK" << endl;
+
+                // the worker pool is stopped by close and restarted on demand
+                cout << "Comparing parallel signals after reopening .... ";
+                r_par.close( );
+                r_par.open( reffile, flags );
+                r_serial.getSignals( buf_serial );
+                r_par.getSignals( buf_par );
+                if( !compare( buf_serial, buf_par ) )
+                    throw(std::invalid_argument("ERROR -- Parallel signals differ after reopening."));
+                cout << "OK" << endl;
+
+                r_par.close( );
+            }
+            r_serial.close( );
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
@@ -0,0 +1,102 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+#include <boost/thread/thread.hpp>
+
+using namespace std;
+
+const string reffile = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+bool sameRecord( gdf::Reader &ra, gdf::Record *a, gdf::Record *b )
+{
+    for( size_t ch=0; ch<ra.getMainHeader_readonly( ).get_num_signals( ); ch++ )
+    {
+        size_t spr = ra.getSignalHeader_readonly( ch ).get_samples_per_record( );
+        for( size_t i=0; i<spr; i++ )
+            if( !same( a->getChannel( ch )->getSamplePhys( i ), b->getChannel( ch )->getSamplePhys( i ) ) )
+                return false;
+    }
+    return true;
+}
+
+int main( )
+{
+    try
+    {
+        gdf::Reader r_ref;
+        r_ref.open( reffile );
+        size_t num_recs = boost::numeric_cast<size_t>( r_ref.getMainHeader_readonly( ).get_num_datarecords( ) );
+
+        for( int cached=0; cached<=1; cached++ )
+        {
+            gdf::Reader r;
+            r.enableCache( cached != 0 );
+            r.enablePrefetch( 4 );
+            r.open( reffile );
+
+            cout << "Sequential access with prefetch, cache " << ( cached ? "enabled" : "disabled" ) << " .... ";
+            for( size_t n=0; n<num_recs; n++ )
+            {
+                // give the prefetch thread some time to run ahead
+                if( n < 8 )
+                    boost::this_thread::sleep( boost::posix_time::milliseconds( 10 ) );
+                if( !sameRecord( r_ref, r_ref.getRecordPtr( n ), r.getRecordPtr( n ) ) )
+                    throw(std::invalid_argument("ERROR -- Records differ."));
+            }
+            if( r.getPrefetchHits( ) == 0 )
+                throw(std::invalid_argument("ERROR -- No record was prefetched."));
+            cout << "OK (" << r.getPrefetchHits( ) << " prefetched)" << endl;
+
+            cout << "Random access with prefetch .... ";
+            for( size_t k=0; k<num_recs; k++ )
+            {
+                size_t n = ( k * 7 ) % num_recs;
+                if( !sameRecord( r_ref, r_ref.getRecordPtr( n ), r.getRecordPtr( n ) ) )
+                    throw(std::invalid_argument("ERROR -- Records differ."));
+            }
+            cout << "OK" << endl;
+
+            r.close( );
+        }
+        r_ref.close( );
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
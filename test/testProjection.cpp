@@ -0,0 +1,127 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+bool compare( const std::vector< std::vector< double > > &a, const std::vector< std::vector< double > > &b )
+{
+    if( a.size( ) != b.size( ) )
+        return false;
+    for( size_t ch=0; ch<a.size(); ch++ )
+    {
+        if( a[ch].size( ) != b[ch].size( ) )
+            return false;
+        for( size_t n=0; n<a[ch].size(); n++ )
+            if( !same( a[ch][n], b[ch][n] ) )
+                return false;
+    }
+    return true;
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            gdf::Reader r_full, r_proj;
+
+            cout << "Opening '" << reffile << "' for reading." << endl;
+            r_full.open( reffile );
+            r_full.enableCache( false );
+            r_proj.open( reffile );
+            r_proj.enableCache( false );
+            r_proj.enableProjection( true );
+
+            size_t ns = r_full.getMainHeader_readonly( ).get_num_signals( );
+
+            // last and first channel, a duplicate, and two adjacent channels
+            std::vector<gdf::uint16> channels;
+            channels.push_back( boost::numeric_cast<gdf::uint16>( ns-1 ) );
+            channels.push_back( 0 );
+            channels.push_back( 0 );
+            if( ns > 3 )
+            {
+                channels.push_back( 2 );
+                channels.push_back( 1 );
+            }
+
+            cout << "Comparing projected signals .... ";
+            std::vector< std::vector< double > > buf_full, buf_proj;
+            r_full.getSignals( buf_full, 0, -1, channels );
+            r_proj.getSignals( buf_proj, 0, -1, channels );
+            if( !compare( buf_full, buf_proj ) )
+                throw(std::invalid_argument("ERROR -- Projected signals differ."));
+            cout << "OK" << endl;
+
+            cout << "Comparing projected single channel .... ";
+            size_t N = buf_full[0].size( );
+            std::vector<double> single( N );
+            r_proj.getSignal( channels[0], &single[0] );
+            for( size_t n=0; n<N; n++ )
+                if( !same( single[n], buf_full[0][n] ) )
+                    throw(std::invalid_argument("ERROR -- Projected getSignal differs."));
+            cout << "OK" << endl;
+
+            cout << "Comparing projected signals with partially cached records .... ";
+            r_proj.enableCache( true );
+            r_proj.getRecordPtr( 0 );
+            r_proj.getSignals( buf_proj, 0, -1, channels );
+            if( !compare( buf_full, buf_proj ) )
+                throw(std::invalid_argument("ERROR -- Projected signals differ."));
+            cout << "OK" << endl;
+
+            r_full.close( );
+            r_proj.close( );
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
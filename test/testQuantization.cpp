@@ -0,0 +1,184 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include <GDF/Conversion.h>
+#include <GDF/Writer.h>
+#include <GDF/Reader.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <iostream>
+#include <limits>
+#include <stdio.h>
+#include <math.h>
+
+using namespace std;
+
+const string testfile = "testquantization.gdf.tmp";
+const size_t N = 100;
+
+/// Convert a single value without saturation; returns -1 on negative overflow and 1 on positive overflow
+template<typename T>
+int convertOne( double phys, T &raw )
+{
+    try {
+        gdf::convertPhysToRaw( &phys, &raw, 1, 1.0, 0.0, false );
+    } catch( boost::numeric::negative_overflow & ) {
+        return -1;
+    } catch( boost::numeric::positive_overflow & ) {
+        return 1;
+    }
+    return 0;
+}
+
+/// Check the range boundaries of the conversion kernel
+bool checkBoundaries( )
+{
+    gdf::int16 i16;
+    gdf::uint8 u8;
+    gdf::uint32 u32;
+    if( convertOne( -32768.5, i16 ) != -1 ) return false;
+    if( convertOne( 32767.5, i16 ) != 1 ) return false;
+    if( convertOne( -32768.49, i16 ) != 0 || i16 != -32768 ) return false;
+    if( convertOne( 32767.49, i16 ) != 0 || i16 != 32767 ) return false;
+    if( convertOne( 255.5, u8 ) != 1 ) return false;
+    if( convertOne( 255.49, u8 ) != 0 || u8 != 255 ) return false;
+    if( convertOne( -0.5, u32 ) != -1 ) return false;
+    if( convertOne( -0.49, u32 ) != 0 || u32 != 0 ) return false;
+    if( convertOne( 4294967295.5, u32 ) != 1 ) return false;
+
+    // half a step is below the double resolution at the ends of the 64 bit ranges; the ends themselves are valid
+    gdf::int64 i64;
+    gdf::uint64 u64;
+    const double i64_lo = gdf::rawLowest<gdf::int64>( ), i64_hi = gdf::rawHighest<gdf::int64>( );
+    const double u64_hi = gdf::rawHighest<gdf::uint64>( );
+    if( convertOne( i64_lo, i64 ) != 0 || i64 != std::numeric_limits<gdf::int64>::min( ) ) return false;
+    if( convertOne( nextafter( i64_lo, -1e300 ), i64 ) != -1 ) return false;
+    if( convertOne( i64_hi, i64 ) != 0 || double( i64 ) != i64_hi ) return false;
+    if( convertOne( nextafter( i64_hi, 1e300 ), i64 ) != 1 ) return false;
+    if( convertOne( u64_hi, u64 ) != 0 || double( u64 ) != u64_hi ) return false;
+    if( convertOne( nextafter( u64_hi, 1e300 ), u64 ) != 1 ) return false;
+    if( convertOne( -0.5, u64 ) != -1 ) return false;
+
+    // saturated values are accepted without saturation
+    double big[2] = { -1e30, 1e30 };
+    gdf::int64 si64[2];
+    gdf::uint64 su64[2];
+    gdf::convertPhysToRaw( big, si64, 2, 1.0, 0.0, true );
+    gdf::convertPhysToRaw( big, su64, 2, 1.0, 0.0, true );
+    for( size_t i=0; i<2; i++ )
+    {
+        if( convertOne( double( si64[i] ), i64 ) != 0 || i64 != si64[i] ) return false;
+        if( convertOne( double( su64[i] ), u64 ) != 0 || u64 != su64[i] ) return false;
+    }
+    return true;
+}
+
+int main( )
+{
+    try
+    {
+        cout << "Checking conversion range boundaries .... ";
+        if( !checkBoundaries( ) )
+        {
+            cout << "Failed." << endl;
+            return 1;
+        }
+        cout << "OK" << endl;
+
+        gdf::Writer w;
+        w.setEventSamplingRate( 100 );
+        w.createSignal( 0 );
+        w.getSignalHeader( 0 ).set_label( "quantization" );
+        w.getSignalHeader( 0 ).set_datatype( gdf::INT8 );
+        w.getSignalHeader( 0 ).set_samplerate( N );
+        w.getSignalHeader( 0 ).set_digmin( -100 );
+        w.getSignalHeader( 0 ).set_digmax( 100 );
+        w.getSignalHeader( 0 ).set_physmin( -1 );
+        w.getSignalHeader( 0 ).set_physmax( 1 );
+
+        try {
+            w.open( testfile, gdf::writer_ev_memory | gdf::writer_overwrite );
+        } catch( gdf::exception::header_issues &e )
+        {
+            if( e.num_errors() > 0 ) throw;
+        }
+
+        std::vector<double> phys( N );
+        std::vector<double> expected( N );
+        for( size_t i=0; i<N; i++ )
+        {
+            // values just below and above half a quantization step
+            phys[i] = ( static_cast<double>( i ) - 50.0 ) / 100.0 + ( i%2 ? 0.006 : -0.004 );
+            expected[i] = ( static_cast<double>( i ) - 50.0 ) / 100.0 + ( i%2 ? 0.01 : 0.0 );
+        }
+        // out of int8 range; saturated to -128 and 127
+        phys[0] = -2.0;
+        phys[N-1] = 1.5;
+        expected[0] = -1.28;
+        expected[N-1] = 1.27;
+
+        cout << "Writing out of range samples without saturation .... ";
+        bool thrown = false;
+        try {
+            w.blitSamplesPhys( 0, &phys[0], N );
+        } catch( boost::numeric::bad_numeric_cast & ) {
+            thrown = true;
+        }
+        if( !thrown )
+        {
+            cout << "Failed." << endl;
+            return 1;
+        }
+        cout << "OK" << endl;
+
+        cout << "Writing out of range samples with saturation .... ";
+        w.enableSaturation( true );
+        w.blitSamplesPhys( 0, &phys[0], N );
+        w.close( );
+        cout << "OK" << endl;
+
+        cout << "Checking rounding and saturation .... ";
+        gdf::Reader r;
+        r.open( testfile );
+        std::vector<double> readback( N );
+        r.getSignal( 0, &readback[0] );
+        r.close( );
+        for( size_t i=0; i<N; i++ )
+            if( fabs( readback[i] - expected[i] ) > 1e-9 )
+            {
+                cout << "Failed at sample " << i << ": " << readback[i] << " != " << expected[i] << endl;
+                return 1;
+            }
+        cout << "OK" << endl;
+
+        remove( testfile.c_str() );
+
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
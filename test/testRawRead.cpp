@@ -0,0 +1,146 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+// reads channel ch raw in three ways and compares against the physical samples in ref
+template<typename T>
+void checkChannel( gdf::Reader &r, gdf::uint16 ch, const std::vector<double> &ref )
+{
+    const gdf::SignalHeader &sh = r.getSignalHeader_readonly( ch );
+    std::vector<gdf::uint16> channels( 1, ch );
+
+    std::vector< std::vector<T> > raw;
+    r.getSignalsRaw( raw, 0, -1, channels );
+    if( raw.size( ) != 1 || raw[0].size( ) != ref.size( ) )
+        throw(std::invalid_argument("ERROR -- Wrong number of raw samples."));
+    for( size_t n=0; n<ref.size(); n++ )
+        if( !same( sh.raw_to_phys( static_cast<double>( raw[0][n] ) ), ref[n] ) )
+            throw(std::invalid_argument("ERROR -- Raw samples differ."));
+
+    size_t N = ref.size( );
+    if( N < 3 )
+        return;
+    std::vector<T> single( N/2 );
+    r.getSignalRaw( ch, &single[0], N/3, N/3 + single.size( ) );
+    for( size_t n=0; n<single.size(); n++ )
+        if( single[n] != raw[0][N/3+n] && !( single[n] != single[n] ) )
+            throw(std::invalid_argument("ERROR -- getSignalRaw differs."));
+
+    // every other sample of a caller owned buffer
+    std::vector<T> strided( 2 * N );
+    r.getSignalsRaw( &strided[0], 0, 2, 0, -1, channels );
+    for( size_t n=0; n<N; n++ )
+        if( strided[2*n] != raw[0][n] && !( strided[2*n] != strided[2*n] ) )
+            throw(std::invalid_argument("ERROR -- Strided raw samples differ."));
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            for( int mode=0; mode<3; mode++ )
+            {
+                gdf::Reader r;
+                cout << "Opening '" << reffile << "' for reading." << endl;
+                r.open( reffile, mode == 1 ? gdf::reader_mmap : gdf::reader_default );
+                if( mode == 2 )
+                    r.setNumThreads( 4 );
+
+                std::vector< std::vector< double > > ref;
+                r.getSignals( ref );
+
+                cout << "Comparing raw signals (mode " << mode << ") .... ";
+                for( gdf::uint16 ch=0; ch<ref.size(); ch++ )
+                {
+                    switch( r.getSignalHeader_readonly( ch ).get_datatype( ) )
+                    {
+                    case gdf::INT8: checkChannel<gdf::int8>( r, ch, ref[ch] ); break;
+                    case gdf::UINT8: checkChannel<gdf::uint8>( r, ch, ref[ch] ); break;
+                    case gdf::INT16: checkChannel<gdf::int16>( r, ch, ref[ch] ); break;
+                    case gdf::UINT16: checkChannel<gdf::uint16>( r, ch, ref[ch] ); break;
+                    case gdf::INT32: checkChannel<gdf::int32>( r, ch, ref[ch] ); break;
+                    case gdf::UINT32: checkChannel<gdf::uint32>( r, ch, ref[ch] ); break;
+                    case gdf::INT64: checkChannel<gdf::int64>( r, ch, ref[ch] ); break;
+                    case gdf::UINT64: checkChannel<gdf::uint64>( r, ch, ref[ch] ); break;
+                    case gdf::FLOAT32: checkChannel<gdf::float32>( r, ch, ref[ch] ); break;
+                    case gdf::FLOAT64: checkChannel<gdf::float64>( r, ch, ref[ch] ); break;
+                    }
+                }
+                cout << "OK" << endl;
+
+                cout << "Checking type mismatch .... ";
+                bool thrown = false;
+                try
+                {
+                    std::vector< std::vector<gdf::int8> > wrong;
+                    std::vector<gdf::uint16> channels( 1, 0 );
+                    if( r.getSignalHeader_readonly( 0 ).get_datatype( ) == gdf::INT8 )
+                        thrown = true;
+                    else
+                        r.getSignalsRaw( wrong, 0, -1, channels );
+                }
+                catch( gdf::exception::bad_type_assigned_to_channel & )
+                {
+                    thrown = true;
+                }
+                if( !thrown )
+                    throw(std::invalid_argument("ERROR -- Type mismatch not detected."));
+                cout << "OK" << endl;
+
+                r.close( );
+            }
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
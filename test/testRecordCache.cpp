@@ -0,0 +1,105 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+
+int main( )
+{
+    try
+    {
+        gdf::Reader r_full, r_limited;
+
+        cout << "Opening '" << reffile << "' for reading." << endl;
+        r_full.open( reffile );
+        r_limited.open( reffile );
+
+        const size_t max_records = 3;
+        r_limited.setMaxCacheRecords( max_records );
+
+        cout << "Comparing signals .... ";
+        std::vector< std::vector< double > > buf_full, buf_limited;
+        r_full.getSignals( buf_full );
+        r_limited.getSignals( buf_limited );
+
+        for( size_t ch=0; ch<buf_full.size(); ch++ )
+            if( buf_full[ch] != buf_limited[ch] )
+                throw(std::invalid_argument("ERROR -- Signals differ."));
+
+        size_t num_recs = boost::numeric_cast<size_t>( r_full.getMainHeader_readonly( ).get_num_datarecords( ) );
+        if( r_full.getNumCachedRecords( ) != num_recs )
+            throw(std::invalid_argument("ERROR -- Unlimited cache does not hold all records."));
+        if( r_limited.getNumCachedRecords( ) != max_records )
+            throw(std::invalid_argument("ERROR -- Cache limit not respected."));
+        if( r_limited.getCacheMisses( ) != num_recs || r_limited.getCacheHits( ) != 0 )
+            throw(std::invalid_argument("ERROR -- Wrong cache statistics."));
+        cout << "OK" << endl;
+
+        cout << "Checking recently used records stay cached .... ";
+        r_limited.resetCacheStatistics( );
+        for( size_t n=0; n<num_recs; n++ )
+        {
+            // record 0 is accessed all the time, so it must never be evicted
+            r_limited.getRecordPtr( 0 );
+            gdf::Record *a = r_limited.getRecordPtr( n );
+            gdf::Record *b = r_full.getRecordPtr( n );
+            for( size_t ch=0; ch<buf_full.size(); ch++ )
+                if( a->getChannel( ch )->getSamplePhys( 0 ) != b->getChannel( ch )->getSamplePhys( 0 ) )
+                    throw(std::invalid_argument("ERROR -- Records differ."));
+        }
+        if( r_limited.getCacheMisses( ) != num_recs )
+            throw(std::invalid_argument("ERROR -- Frequently used record was evicted."));
+        cout << "OK" << endl;
+
+        cout << "Checking byte budget .... ";
+        r_limited.setMaxCacheRecords( 0 );
+        size_t record_bytes = 0;
+        for( size_t ch=0; ch<buf_full.size(); ch++ )
+        {
+            const gdf::SignalHeader &sh = r_full.getSignalHeader_readonly( ch );
+            record_bytes += gdf::datatype_size( sh.get_datatype( ) ) * sh.get_samples_per_record( );
+        }
+        r_limited.setMaxCacheBytes( 5 * record_bytes );
+        r_limited.getSignals( buf_limited );
+        if( r_limited.getNumCachedRecords( ) != 5 )
+            throw(std::invalid_argument("ERROR -- Byte budget not respected."));
+        cout << "OK" << endl;
+
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
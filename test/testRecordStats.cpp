@@ -0,0 +1,229 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Writer.h>
+#include <GDF/Reader.h>
+#include <GDF/RecordStats.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+const string testfile = "testrecordstats.gdf.tmp";
+const string testindex = "testrecordstats.rsi.tmp";
+
+bool close_to( double a, double b )
+{
+    if( a != a || b != b )
+        return a != a && b != b;
+    return fabs( a - b ) <= 1e-5 * std::max( 1.0, fabs( b ) );
+}
+
+bool same( const gdf::RecordStat &a, const gdf::RecordStat &b )
+{
+    return close_to( a.min, b.min ) && close_to( a.max, b.max ) && close_to( a.mean, b.mean )
+        && close_to( a.rms, b.rms ) && a.nan_count == b.nan_count;
+}
+
+gdf::RecordStat bruteForce( const std::vector<double> &x, size_t begin, size_t end )
+{
+    gdf::RecordStat s;
+    double mn = 1e300, mx = -1e300, sum = 0, sumsq = 0;
+    size_t n = 0;
+    s.nan_count = 0;
+    for( size_t i=begin; i<end; i++ )
+    {
+        if( x[i] != x[i] )
+        {
+            s.nan_count++;
+            continue;
+        }
+        mn = std::min( mn, x[i] );
+        mx = std::max( mx, x[i] );
+        sum += x[i];
+        sumsq += x[i] * x[i];
+        n++;
+    }
+    double nan = std::numeric_limits<double>::quiet_NaN( );
+    s.min = float( n ? mn : nan );
+    s.max = float( n ? mx : nan );
+    s.mean = float( n ? sum / n : nan );
+    s.rms = float( n ? sqrt( sumsq / n ) : nan );
+    return s;
+}
+
+void compare( gdf::Reader &r, const gdf::RecordStatsIndex &index )
+{
+    std::vector< std::vector< double > > data;
+    r.getSignals( data );
+    size_t num_recs = boost::numeric_cast<size_t>( r.getMainHeader_readonly( ).get_num_datarecords( ) );
+    if( index.getNumRecords( ) != num_recs || index.getNumChannels( ) != data.size( ) )
+        throw(std::invalid_argument("ERROR -- Wrong index size."));
+    for( size_t ch=0; ch<data.size(); ch++ )
+    {
+        gdf::uint16 c = boost::numeric_cast<gdf::uint16>( ch );
+        size_t spr = index.getSamplesPerRecord( c );
+        for( size_t n=0; n<num_recs; n++ )
+            if( !same( index.get( n, c ), bruteForce( data[ch], n*spr, (n+1)*spr ) ) )
+                throw(std::invalid_argument("ERROR -- Record statistics differ."));
+        if( !same( index.getSummary( c ), bruteForce( data[ch], 0, data[ch].size( ) ) ) )
+            throw(std::invalid_argument("ERROR -- Channel summary differs."));
+    }
+}
+
+void copyFile( const std::string &from, const std::string &to )
+{
+    std::ifstream src( from.c_str( ), std::ios_base::in | std::ios_base::binary );
+    std::ofstream dst( to.c_str( ), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+    dst << src.rdbuf( );
+}
+
+/// Write an index header with the given sizes, followed by extra zero bytes, and check that loading it fails
+bool rejectsCorrupt( gdf::uint32 ns, gdf::uint64 num_records, size_t extra )
+{
+    {
+        std::ofstream file( testindex.c_str( ), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+        file.write( "GDFRSI01", 8 );
+        gdf::writeLittleEndian( file, ns );
+        gdf::writeLittleEndian( file, num_records );
+        file << std::string( extra, '\0' );
+    }
+    gdf::RecordStatsIndex index;
+    try {
+        index.load( testindex );
+    } catch( gdf::exception::serialization_error & ) {
+        return true;
+    }
+    return false;
+}
+
+int main( )
+{
+    try
+    {
+        gdf::Reader r;
+        cout << "Opening '" << reffile0 << "' for reading." << endl;
+        r.open( reffile0 );
+
+        cout << "Building index while writing .... ";
+        gdf::Writer w;
+        w.getMainHeader( ).copyFrom( r.getMainHeader_readonly() );
+        w.getHeaderAccess().setRecordDuration( r.getMainHeader_readonly().get_datarecord_duration( 0 ), r.getMainHeader_readonly().get_datarecord_duration( 1 ) );
+        for( size_t m=0; m<w.getMainHeader_readonly().get_num_signals(); m++ )
+        {
+            w.createSignal( m, true );
+            w.getSignalHeader( m ).copyFrom( r.getSignalHeader_readonly( m ) );
+        }
+        w.enableRecordStats( true );
+        w.open( testfile, gdf::writer_ev_memory | gdf::writer_overwrite );
+        size_t num_recs = boost::numeric_cast<size_t>( r.getMainHeader_readonly( ).get_num_datarecords( ) );
+        for( size_t n=0; n<num_recs; n++ )
+        {
+            gdf::Record *rec = w.acquireRecord( );
+            r.readRecord( n, rec );
+            w.addRecord( rec );
+        }
+        w.close( );
+
+        gdf::Reader r2;
+        r2.open( testfile );
+        compare( r2, r2.getRecordStats( ) );
+        cout << "OK" << endl;
+
+        cout << "Building index from file .... ";
+        gdf::RecordStatsIndex built;
+        built.build( r );
+        compare( r, built );
+        for( size_t n=0; n<num_recs; n++ )
+            for( gdf::uint16 c=0; c<built.getNumChannels(); c++ )
+                if( !same( built.get( n, c ), r2.getRecordStats( ).get( n, c ) ) )
+                    throw(std::invalid_argument("ERROR -- Indices differ."));
+        r2.close( );
+        r.close( );
+
+        gdf::Reader r3;
+        r3.open( alltypesfile );
+        built.build( r3 );
+        built.save( testindex );
+        gdf::RecordStatsIndex loaded;
+        loaded.load( testindex );
+        compare( r3, loaded );
+        r3.close( );
+        cout << "OK" << endl;
+
+        cout << "Rejecting a stale index .... ";
+        // the sidecar of testfile describes alltypes; a different file of the same name must not use it
+        built.save( gdf::RecordStatsIndex::getSidecarName( testfile ) );
+        copyFile( reffile0, testfile );
+        gdf::Reader r4;
+        r4.open( testfile );
+        bool thrown = false;
+        try {
+            r4.getRecordStats( );
+        } catch( gdf::exception::serialization_error & ) {
+            thrown = true;
+        }
+        r4.close( );
+        if( !thrown )
+            throw(std::invalid_argument("ERROR -- Stale index accepted."));
+        copyFile( alltypesfile, testfile );
+        r4.open( testfile );
+        compare( r4, r4.getRecordStats( ) );
+        r4.close( );
+        cout << "OK" << endl;
+
+        cout << "Rejecting corrupt index files .... ";
+        if( !rejectsCorrupt( 1000, 0, 16 ) )     // samples per record truncated
+            throw(std::invalid_argument("ERROR -- Truncated channel list accepted."));
+        if( !rejectsCorrupt( 1, gdf::uint64( 1 ) << 40, 4 + 20 ) )   // far more records than the file holds
+            throw(std::invalid_argument("ERROR -- Oversized record count accepted."));
+        if( !rejectsCorrupt( 0xffffffff, gdf::uint64( 1 ) << 40, 0 ) )
+            throw(std::invalid_argument("ERROR -- Oversized channel count accepted."));
+        if( rejectsCorrupt( 1, 1, 4 + 20 ) )
+            throw(std::invalid_argument("ERROR -- Valid index rejected."));
+        cout << "OK" << endl;
+
+        remove( testfile.c_str() );
+        remove( gdf::RecordStatsIndex::getSidecarName( testfile ).c_str() );
+        remove( testindex.c_str() );
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    remove( testfile.c_str() );
+    remove( gdf::RecordStatsIndex::getSidecarName( testfile ).c_str() );
+    remove( testindex.c_str() );
+    return 1;   // test failed
+}
@@ -0,0 +1,154 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string neqsfile = string(GDF_SOURCE_ROOT)+"/sampledata/NEQSuint32Ch678.GDF";
+
+bool byPosition( const gdf::Mode3Event &a, const gdf::Mode3Event &b )
+{
+    return a.position < b.position;
+}
+
+int main( )
+{
+    try
+    {
+        gdf::Reader r;
+        cout << "Opening '" << neqsfile << "' for reading." << endl;
+        r.open( neqsfile );
+
+        cout << "Comparing bulk sparse samples with eventToSample .... ";
+        std::vector< std::vector<double> > times, values;
+        r.getSparseSignals( times, values );
+        size_t ns = r.getMainHeader_readonly( ).get_num_signals( );
+        if( times.size( ) != ns || values.size( ) != ns )
+            throw(std::invalid_argument("ERROR -- Wrong number of channels."));
+
+        const std::vector<gdf::Mode3Event> &events = r.getEventHeader( )->getMode3Events_readonly( );
+        size_t num_sparse = 0;
+        for( size_t ch=0; ch<ns; ch++ )
+        {
+            std::vector<gdf::Mode3Event> ref;
+            for( size_t i=0; i<events.size(); i++ )
+                if( events[i].type == 0x7fff && events[i].channel == ch + 1 )
+                    ref.push_back( events[i] );
+            std::stable_sort( ref.begin( ), ref.end( ), byPosition );
+
+            if( r.getSignalHeader_readonly( ch ).get_samples_per_record( ) != 0 )
+            {
+                if( !times[ch].empty( ) || !values[ch].empty( ) )
+                    throw(std::invalid_argument("ERROR -- Samples for a regular channel."));
+                continue;
+            }
+
+            if( times[ch].size( ) != ref.size( ) || values[ch].size( ) != ref.size( ) )
+                throw(std::invalid_argument("ERROR -- Wrong number of sparse samples."));
+            for( size_t i=0; i<ref.size(); i++ )
+            {
+                double t, v;
+                r.eventToSample( t, v, ref[i] );
+                if( t != times[ch][i] || v != values[ch][i] )
+                    throw(std::invalid_argument("ERROR -- Sparse samples differ."));
+            }
+
+            std::vector<double> t1, v1;
+            r.getSparseSignal( boost::numeric_cast<gdf::uint16>( ch ), t1, v1 );
+            if( t1 != times[ch] || v1 != values[ch] )
+                throw(std::invalid_argument("ERROR -- getSparseSignal differs."));
+            num_sparse += ref.size( );
+        }
+        if( num_sparse == 0 )
+            throw(std::invalid_argument("ERROR -- Test file has no sparse samples."));
+        cout << "OK" << endl;
+
+        cout << "Rejecting regular channels .... ";
+        bool thrown = false;
+        for( gdf::uint16 ch=0; ch<ns && !thrown; ch++ )
+        {
+            if( r.getSignalHeader_readonly( ch ).get_samples_per_record( ) == 0 )
+                continue;
+            try
+            {
+                std::vector<double> t, v;
+                r.getSparseSignal( ch, t, v );
+            }
+            catch( gdf::exception::event_conversion_error & )
+            {
+                thrown = true;
+            }
+        }
+        if( !thrown )
+            throw(std::invalid_argument("ERROR -- Regular channel accepted."));
+        cout << "OK" << endl;
+
+        cout << "Checking position limits against posToSec .... ";
+        gdf::EventHeader *eh = r.getEventHeader( );
+        gdf::uint16 sparse_ch = 0;
+        while( r.getSignalHeader_readonly( sparse_ch ).get_samples_per_record( ) != 0 )
+            sparse_ch++;
+        gdf::Mode3Event ev = eh->getMode3Events_readonly( ).front( );
+        ev.type = 0x7fff;
+        ev.channel = boost::numeric_cast<gdf::uint16>( sparse_ch + 1 );
+        ev.position = 0x80000000;   // the last valid position
+        eh->addEvent( ev );
+        std::vector<double> t, v;
+        r.getSparseSignal( sparse_ch, t, v );
+        if( t.back( ) != eh->posToSec( ev.position ) )
+            throw(std::invalid_argument("ERROR -- Last valid position differs."));
+        ev.position = 0x80000001;
+        eh->addEvent( ev );
+        bool bulk_thrown = false, single_thrown = false;
+        try {
+            r.getSparseSignal( sparse_ch, t, v );
+        } catch( gdf::exception::invalid_operation & ) {
+            bulk_thrown = true;
+        }
+        try {
+            eh->posToSec( ev.position );
+        } catch( gdf::exception::invalid_operation & ) {
+            single_thrown = true;
+        }
+        if( !bulk_thrown || !single_thrown )
+            throw(std::invalid_argument("ERROR -- Position past the int32 range accepted."));
+        cout << "OK" << endl;
+
+        r.close( );
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
@@ -0,0 +1,127 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Writer.h>
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string testfile = "testsparsebulk.gdf.tmp";
+const string neqsfile = string(GDF_SOURCE_ROOT)+"/sampledata/NEQSuint32Ch678.GDF";
+
+int main( )
+{
+    try
+    {
+        gdf::Reader r;
+        cout << "Opening '" << neqsfile << "' for reading." << endl;
+        r.open( neqsfile );
+
+        gdf::Writer w;
+        w.getMainHeader( ).copyFrom( r.getMainHeader_readonly() );
+        w.getHeaderAccess().setRecordDuration( r.getMainHeader_readonly().get_datarecord_duration( 0 ), r.getMainHeader_readonly().get_datarecord_duration( 1 ) );
+        for( size_t m=0; m<w.getMainHeader_readonly().get_num_signals(); m++ )
+        {
+            w.createSignal( m, true );
+            w.getSignalHeader( m ).copyFrom( r.getSignalHeader_readonly( m ) );
+        }
+        w.setEventMode( 3 );
+        w.setEventSamplingRate( r.getEventHeader()->getSamplingRate() );
+        w.open( testfile, gdf::writer_ev_memory | gdf::writer_overwrite );
+
+        size_t num_recs = boost::numeric_cast<size_t>( r.getMainHeader_readonly( ).get_num_datarecords( ) );
+        for( size_t n=0; n<num_recs; n++ )
+        {
+            gdf::Record *rec = w.acquireRecord( );
+            r.readRecord( n, rec );
+            w.addRecord( rec );
+        }
+
+        cout << "Writing sparse samples in batches .... ";
+        std::vector< std::vector<double> > times, values;
+        r.getSparseSignals( times, values );
+        size_t num_sparse = 0;
+        for( size_t ch=0; ch<times.size(); ch++ )
+        {
+            if( times[ch].empty( ) )
+                continue;
+            w.addSparseSamples( boost::numeric_cast<gdf::uint16>( ch + 1 ), &times[ch][0], &values[ch][0], times[ch].size( ) );
+            num_sparse += times[ch].size( );
+        }
+        if( num_sparse == 0 )
+            throw(std::invalid_argument("ERROR -- Test file has no sparse samples."));
+        cout << "OK" << endl;
+
+        cout << "Rejecting invalid batches .... ";
+        size_t rejected = 0;
+        for( size_t ch=0; ch<times.size(); ch++ )
+        {
+            if( times[ch].size( ) < 2 )
+                continue;
+            std::vector<double> t = times[ch];
+            t.back( ) = -1.0;   // the last time is invalid, so nothing of the batch may be written
+            try
+            {
+                w.addSparseSamples( boost::numeric_cast<gdf::uint16>( ch + 1 ), &t[0], &values[ch][0], t.size( ) );
+            }
+            catch( gdf::exception::invalid_operation & )
+            {
+                rejected++;
+            }
+            break;
+        }
+        if( rejected != 1 )
+            throw(std::invalid_argument("ERROR -- Invalid time accepted."));
+        cout << "OK" << endl;
+
+        w.close( );
+
+        cout << "Comparing sparse samples .... ";
+        gdf::Reader r2;
+        r2.open( testfile );
+        if( r2.getEventHeader( )->getNumEvents( ) != num_sparse )
+            throw(std::invalid_argument("ERROR -- Wrong number of events."));
+        std::vector< std::vector<double> > times2, values2;
+        r2.getSparseSignals( times2, values2 );
+        if( times2 != times || values2 != values )
+            throw(std::invalid_argument("ERROR -- Sparse samples differ."));
+        r2.close( );
+        cout << "OK" << endl;
+
+        r.close( );
+        remove( testfile.c_str() );
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
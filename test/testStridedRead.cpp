@@ -0,0 +1,125 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+#include "config-tests.h"
+
+#include <GDF/Reader.h>
+
+#include <iostream>
+#include <stdio.h>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+using namespace std;
+
+const string reffile0 = string(GDF_SOURCE_ROOT)+"/sampledata/MI128.gdf";
+const string alltypesfile = string(GDF_SOURCE_ROOT)+"/sampledata/alltypes.gdf";
+
+bool same( double a, double b )
+{
+    return a == b || ( a != a && b != b );
+}
+
+// compares a strided buffer against getSignals( vector ) output
+template<typename U>
+bool compare( const std::vector< std::vector< double > > &ref, const std::vector<U> &buf, size_t channel_stride, size_t sample_stride )
+{
+    for( size_t ch=0; ch<ref.size(); ch++ )
+        for( size_t n=0; n<ref[ch].size(); n++ )
+            if( !same( static_cast<U>( ref[ch][n] ), buf[ch*channel_stride + n*sample_stride] ) )
+                return false;
+    return true;
+}
+
+int main( )
+{
+    std::vector<string> infilelist;
+    infilelist.push_back(reffile0);
+    infilelist.push_back(alltypesfile);
+
+    try
+    {
+        for( size_t file_count=0; file_count < infilelist.size(); file_count++ )
+        {
+            string reffile = infilelist[file_count];
+
+            gdf::Reader r;
+            cout << "Opening '" << reffile << "' for reading." << endl;
+            r.open( reffile );
+
+            std::vector< std::vector< double > > ref;
+            r.getSignals( ref );
+            size_t M = ref.size( );
+            size_t N = 0;
+            for( size_t ch=0; ch<M; ch++ )
+            {
+                if( r.getNumSamples( boost::numeric_cast<gdf::uint16>( ch ) ) != ref[ch].size( ) )
+                    throw(std::invalid_argument("ERROR -- getNumSamples is wrong."));
+                N = std::max( N, ref[ch].size( ) );
+            }
+
+            for( size_t threads=1; threads<=4; threads+=3 )
+            {
+                r.setNumThreads( threads );
+
+                cout << "Comparing channel-major output (" << threads << " threads) .... ";
+                std::vector<double> buf64( M * N );
+                std::vector<float> buf32( M * N );
+                r.getSignals( &buf64[0], N, 1 );
+                r.getSignals( &buf32[0], N, 1 );
+                if( !compare( ref, buf64, N, 1 ) || !compare( ref, buf32, N, 1 ) )
+                    throw(std::invalid_argument("ERROR -- Channel-major output differs."));
+                cout << "OK" << endl;
+
+                cout << "Comparing interleaved output (" << threads << " threads) .... ";
+                r.getSignals( &buf64[0], 1, M );
+                r.getSignals( &buf32[0], 1, M );
+                if( !compare( ref, buf64, 1, M ) || !compare( ref, buf32, 1, M ) )
+                    throw(std::invalid_argument("ERROR -- Interleaved output differs."));
+                cout << "OK" << endl;
+
+                cout << "Comparing interleaved window (" << threads << " threads) .... ";
+                std::vector<gdf::uint16> channels;
+                channels.push_back( boost::numeric_cast<gdf::uint16>( M - 1 ) );
+                channels.push_back( 0 );
+                double fs = r.getSignalHeader_readonly( 0 ).get_samplerate( );
+                std::vector< std::vector< double > > ref_win;
+                r.getSignals( ref_win, 1.5 / fs, 3.5 / fs, channels );
+                size_t K = std::max( ref_win[0].size( ), ref_win[1].size( ) );
+                std::vector<double> win( 2 * K );
+                r.getSignals( &win[0], 1, 2, 1.5 / fs, 3.5 / fs, channels );
+                if( !compare( ref_win, win, 1, 2 ) )
+                    throw(std::invalid_argument("ERROR -- Interleaved window differs."));
+                cout << "OK" << endl;
+            }
+
+            r.close( );
+        }
+        return 0;   // test succeeded
+    }
+    catch( std::exception &e )
+    {
+        std::cout << "Caught Exception: " << e.what( ) << endl;
+    }
+    catch( ... )
+    {
+        std::cout << "Caught Unknown Exception." << endl;
+    }
+
+    return 1;   // test failed
+}
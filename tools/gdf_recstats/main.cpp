@@ -0,0 +1,155 @@
+//
+// This file is part of libGDF.
+//
+// libGDF is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// libGDF is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with libGDF.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright 2010 Martin Billinger
+
+//---------------------------------------------------------------------------------------
+
+#include <GDF/Reader.h>
+#include <GDF/RecordStats.h>
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <boost/numeric/conversion/cast.hpp>
+#include <boost/program_options.hpp>
+
+namespace po  = boost::program_options;
+
+using std::vector;
+using std::string;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+//---------------------------------------------------------------------------------------
+
+void printSummary( gdf::Reader &reader, const gdf::RecordStatsIndex &index )
+{
+  cout << "  channel\tlabel\tmin\tmax\tmean\trms\tNaN\tflat records\tclipped records" << endl;
+  for( size_t ch=0; ch<index.getNumChannels(); ch++ )
+  {
+    gdf::uint16 c = boost::numeric_cast<gdf::uint16>( ch );
+    const gdf::SignalHeader &sh = reader.getSignalHeader_readonly( ch );
+    size_t flat = 0, clipped = 0;
+    for( size_t r=0; r<index.getNumRecords(); r++ )
+    {
+      const gdf::RecordStat &s = index.get( r, c );
+      if( index.getSamplesPerRecord( c ) > 1 && s.min == s.max )
+        flat++;
+      if( s.min <= sh.get_physmin( ) || s.max >= sh.get_physmax( ) )
+        clipped++;
+    }
+    gdf::RecordStat s = index.getSummary( c );
+    cout << "  " << ch+1 << "\t" << sh.get_label( ) << "\t" << s.min << "\t" << s.max << "\t" << s.mean
+         << "\t" << s.rms << "\t" << s.nan_count << "\t" << flat << "\t" << clipped << endl;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("input-files,i",  po::value< vector<string> >()->composing() , "input files")
+        ("summary,s", "print a per-channel summary of each file")
+        ("rebuild,r", "rebuild existing indices")
+    ;
+
+    po::positional_options_description p;
+    p.add("input-files", -1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).positional(p).run(), vm);
+    po::notify(vm);
+
+    if(vm.count("help") || vm.size() == 0)
+    {
+      cout << "Usage: gdf_recstats [options] files\n";
+      cout << "Builds the per-record statistics index (<file>.rsi) of GDF files.\n";
+      cout << desc;
+      return 0;
+    }
+
+    if(!vm.count("input-files"))
+    {
+      cerr << "Error -- No input file(s) given!" << endl;
+      return(1);
+    }
+
+    const vector<string> &files = vm["input-files"].as< vector<string> >();
+    for( size_t i=0; i<files.size(); i++ )
+    {
+      gdf::Reader reader;
+      reader.open( files[i] );
+
+      gdf::RecordStatsIndex index;
+      string sidecar = gdf::RecordStatsIndex::getSidecarName( files[i] );
+      bool loaded = false;
+      if( !vm.count("rebuild") )
+      {
+        try
+        {
+          index.load( sidecar );
+          loaded = index.matches( reader.getHeaderAccess_readonly( ) );
+          if( !loaded )
+            cerr << files[i] << ": ignoring stale index " << sidecar << endl;
+        }
+        catch( gdf::exception::file_exists_not & )
+        {
+        }
+        catch( gdf::exception::serialization_error &e )
+        {
+          cerr << files[i] << ": ignoring invalid index " << sidecar << " (" << e.what( ) << ")" << endl;
+        }
+      }
+
+      if( loaded )
+        cout << files[i] << ": using existing index " << sidecar << endl;
+      else
+      {
+        cout << files[i] << ": indexing " << reader.getMainHeader_readonly( ).get_num_datarecords( ) << " records ... ";
+        index.build( reader );
+        index.save( sidecar );
+        cout << "done." << endl;
+      }
+
+      if( vm.count("summary") )
+        printSummary( reader, index );
+
+      reader.close( );
+    }
+
+  }
+  catch(std::exception& e)
+  {
+    cerr << "error: " << e.what() << "\n";
+    return 1;
+  }
+  catch(...)
+  {
+    cerr << "Exception of unknown type!\n";
+    return 1;
+  }
+
+  return(0);
+}